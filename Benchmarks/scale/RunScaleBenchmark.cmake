@@ -0,0 +1,334 @@
+# Copyright (c) 2024 Flokart World, Inc.
+#
+# This software is provided 'as-is', without any express or implied
+# warranty. In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+#    1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation would be
+#    appreciated but is not required.
+#
+#    2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+#
+#    3. This notice may not be removed or altered from any source distribution.
+
+
+# Measures a cold and a warm configuration of a project depending on
+# generated local repositories, without any network access.
+#
+#   cmake -D DAPPI_EXECUTABLE=<prebuilt dappi>
+#         [-D REPOSITORIES=<count>] [-D TAGS=<count per repository>]
+#         [-D WORK_DIR=<dir>] [-D OUTPUT=<json file>] [-D PROFILE=ON]
+#         [-D INDEX=ON] [-D "OPTIONS=<VAR>=<value>;..."]
+#         -P RunScaleBenchmark.cmake
+
+cmake_minimum_required (VERSION 3.18)
+
+if (NOT DAPPI_EXECUTABLE)
+  message (
+    FATAL_ERROR
+    "DAPPI_EXECUTABLE must be specified, as building dappi needs network."
+  )
+endif ()
+get_filename_component (DAPPI_EXECUTABLE "${DAPPI_EXECUTABLE}" ABSOLUTE)
+
+if (NOT DEFINED REPOSITORIES)
+  set (REPOSITORIES 50)
+endif ()
+if (NOT DEFINED TAGS)
+  set (TAGS 10)
+endif ()
+if (NOT DEFINED WORK_DIR)
+  set (WORK_DIR "${CMAKE_CURRENT_BINARY_DIR}/dapper-scale")
+endif ()
+get_filename_component (WORK_DIR "${WORK_DIR}" ABSOLUTE)
+if (NOT DEFINED OUTPUT)
+  set (OUTPUT "${WORK_DIR}/scale-results.json")
+endif ()
+
+get_filename_component (-dapperDir "${CMAKE_CURRENT_LIST_DIR}/../.." ABSOLUTE)
+set (-reposDir "${WORK_DIR}/repositories")
+set (-sourceDir "${WORK_DIR}/source")
+set (-binaryDir "${WORK_DIR}/build")
+set (-cacheDir "${WORK_DIR}/cache")
+set (-indexDir "${WORK_DIR}/index")
+
+find_package (Git REQUIRED)
+
+function (_SCALE_NOW -out)
+  # %f is available since CMake 3.23.
+  if (CMAKE_VERSION VERSION_LESS 3.23)
+    string (TIMESTAMP -now "%s" UTC)
+    string (APPEND -now "000000")
+  else ()
+    string (TIMESTAMP -now "%s%f" UTC)
+  endif ()
+  set ("${-out}" "${-now}" PARENT_SCOPE)
+endfunction ()
+
+function (_SCALE_SECONDS -out -begin -end)
+  math (EXPR -micros "${-end} - ${-begin}")
+  math (EXPR -whole "${-micros} / 1000000")
+  math (EXPR -fraction "${-micros} % 1000000 + 1000000")
+  string (SUBSTRING "${-fraction}" 1 6 -fraction)
+  set ("${-out}" "${-whole}.${-fraction}" PARENT_SCOPE)
+endfunction ()
+
+# Appends a blob or a message of fast-import with its length in bytes.
+function (_SCALE_APPEND_DATA -outStream -data)
+  string (LENGTH "${-data}" -length)
+  set (
+    "${-outStream}" "${${-outStream}}data ${-length}\n${-data}\n"
+    PARENT_SCOPE
+  )
+endfunction ()
+
+# Packages form a binary tree under pkg-0, so that the discovery takes as
+# many iterations as the depth of the tree.
+function (_SCALE_DEPENDENCIES -outYaml -index -tag)
+  math (EXPR -minor "${-tag} / 2")
+  set (-yaml)
+  foreach (-offset 1 2)
+    math (EXPR -child "${-index} * 2 + ${-offset}")
+    if (-child LESS REPOSITORIES)
+      string (
+        APPEND -yaml
+        "  pkg-${-child}:\n"
+        "    require: \">= 1.${-minor}.0\"\n"
+        "    location: \"scale:pkg-${-child}\"\n"
+      )
+    endif ()
+  endforeach ()
+  if (-yaml)
+    set (-yaml "dependencies:\n${-yaml}")
+  endif ()
+  set ("${-outYaml}" "${-yaml}" PARENT_SCOPE)
+endfunction ()
+
+function (_SCALE_BUILD_REPOSITORY -index)
+  set (-repoDir "${-reposDir}/pkg-${-index}.git")
+  set (-stream)
+  math (EXPR -lastTag "${TAGS} - 1")
+  foreach (-tag RANGE ${-lastTag})
+    math (EXPR -mark "${-tag} + 1")
+    math (EXPR -time "1700000000 + ${-tag}")
+    string (
+      APPEND -stream
+      "commit refs/heads/main\n"
+      "mark :${-mark}\n"
+      "committer Dapper Scale <scale@example.com> ${-time} +0000\n"
+    )
+    _SCALE_APPEND_DATA(-stream "Version 1.${-tag}.0")
+
+    _SCALE_DEPENDENCIES(-dependencies "${-index}" "${-tag}")
+    string (APPEND -stream "M 100644 inline DependencyAwareness.yml\n")
+    _SCALE_APPEND_DATA(
+      -stream
+      "name: pkg-${-index}\nversion: \"1.${-tag}.0\"\n${-dependencies}"
+    )
+    string (APPEND -stream "M 100644 inline CMakeLists.txt\n")
+    _SCALE_APPEND_DATA(-stream "# pkg-${-index} 1.${-tag}.0\n")
+
+    string (
+      APPEND -stream
+      "\nreset refs/tags/v1.${-tag}.0\nfrom :${-mark}\n\n"
+    )
+  endforeach ()
+
+  set (-streamFile "${-reposDir}/pkg-${-index}.stream")
+  file (WRITE "${-streamFile}" "${-stream}")
+  execute_process (
+    COMMAND "${GIT_EXECUTABLE}" init --bare --quiet "${-repoDir}"
+    RESULT_VARIABLE -code
+  )
+  if (-code EQUAL 0)
+    execute_process (
+      COMMAND "${GIT_EXECUTABLE}" -C "${-repoDir}" fast-import --quiet
+      INPUT_FILE "${-streamFile}"
+      RESULT_VARIABLE -code
+    )
+  endif ()
+  if (-code EQUAL 0)
+    execute_process (
+      COMMAND
+        "${GIT_EXECUTABLE}" -C "${-repoDir}" symbolic-ref HEAD refs/heads/main
+      RESULT_VARIABLE -code
+    )
+  endif ()
+  # Like most hosting services, to allow partial clones.
+  if (-code EQUAL 0)
+    execute_process (
+      COMMAND
+        "${GIT_EXECUTABLE}" -C "${-repoDir}" config uploadpack.allowFilter true
+      RESULT_VARIABLE -code
+    )
+  endif ()
+  if (NOT -code EQUAL 0)
+    message (FATAL_ERROR "Generating ${-repoDir} failed.")
+  endif ()
+  file (REMOVE "${-streamFile}")
+endfunction ()
+
+function (_SCALE_CONFIGURE -outSeconds -phase)
+  set (-args)
+  foreach (-option IN LISTS OPTIONS)
+    list (APPEND -args -D "${-option}")
+  endforeach ()
+  if (PROFILE)
+    list (APPEND -args -D DAPPER_PROFILE=ON)
+  endif ()
+  if (INDEX)
+    list (APPEND -args -D "DAPPER_INDEX_URL=file://${-indexDir}")
+  endif ()
+  if (-phase STREQUAL "cold")
+    file (REMOVE_RECURSE "${-binaryDir}" "${-cacheDir}")
+    file (REMOVE "${-sourceDir}/DependencyAwarenessLock.yml")
+  else ()
+    list (APPEND -args -D DAPPER_INSTALL=ON)
+  endif ()
+
+  message (STATUS "Configuring ${-phase}...")
+  _SCALE_NOW(-begin)
+  execute_process (
+    COMMAND
+      "${CMAKE_COMMAND}"
+      -S "${-sourceDir}"
+      -B "${-binaryDir}"
+      -D "SCALE_DAPPER_DIR=${-dapperDir}"
+      -D "SCALE_REPOSITORIES_DIR=${-reposDir}"
+      -D "SCALE_CACHE_DIR=${-cacheDir}/repositories"
+      -D "DAPPI_EXECUTABLE=${DAPPI_EXECUTABLE}"
+      ${-args}
+    RESULT_VARIABLE -code
+    OUTPUT_FILE "${WORK_DIR}/${-phase}.log"
+    ERROR_FILE "${WORK_DIR}/${-phase}.log"
+  )
+  _SCALE_NOW(-end)
+  if (NOT -code EQUAL 0)
+    message (
+      FATAL_ERROR
+      "Configuring ${-phase} failed. See ${WORK_DIR}/${-phase}.log"
+    )
+  endif ()
+  if (PROFILE)
+    file (
+      RENAME
+        "${-binaryDir}/dapper-profile.json"
+        "${WORK_DIR}/${-phase}-profile.json"
+    )
+  endif ()
+
+  _SCALE_SECONDS(-seconds "${-begin}" "${-end}")
+  message (STATUS "Configuring ${-phase}: ${-seconds}s")
+  set ("${-outSeconds}" "${-seconds}" PARENT_SCOPE)
+endfunction ()
+
+# The index is rebuilt on every run since it depends on dappi as well.
+function (_SCALE_BUILD_INDEX -outSeconds)
+  set (-gitDirs)
+  math (EXPR -lastRepository "${REPOSITORIES} - 1")
+  foreach (-index RANGE ${-lastRepository})
+    list (APPEND -gitDirs "${-reposDir}/pkg-${-index}.git")
+  endforeach ()
+  file (REMOVE_RECURSE "${-indexDir}")
+  file (MAKE_DIRECTORY "${-indexDir}")
+
+  message (STATUS "Building the registry index...")
+  _SCALE_NOW(-begin)
+  execute_process (
+    COMMAND
+      "${DAPPI_EXECUTABLE}" index build -o "${-indexDir}/scale.yml"
+      --git "${GIT_EXECUTABLE}" ${-gitDirs}
+    RESULT_VARIABLE -code
+  )
+  _SCALE_NOW(-end)
+  if (NOT -code EQUAL 0)
+    message (FATAL_ERROR "Building the registry index failed.")
+  endif ()
+
+  _SCALE_SECONDS(-seconds "${-begin}" "${-end}")
+  message (STATUS "Building the registry index: ${-seconds}s")
+  set ("${-outSeconds}" "${-seconds}" PARENT_SCOPE)
+endfunction ()
+
+# Repositories are reused as long as the parameters stay the same.
+set (-parameters "${REPOSITORIES} ${TAGS} allowFilter")
+set (-parametersFile "${-reposDir}/parameters.txt")
+set (-oldParameters)
+if (EXISTS "${-parametersFile}")
+  file (READ "${-parametersFile}" -oldParameters)
+endif ()
+if (NOT -parameters STREQUAL -oldParameters)
+  message (
+    STATUS "Generating ${REPOSITORIES} repositories with ${TAGS} tags each..."
+  )
+  file (REMOVE_RECURSE "${-reposDir}")
+  file (MAKE_DIRECTORY "${-reposDir}")
+  math (EXPR -lastRepository "${REPOSITORIES} - 1")
+  foreach (-index RANGE ${-lastRepository})
+    _SCALE_BUILD_REPOSITORY("${-index}")
+  endforeach ()
+  file (WRITE "${-parametersFile}" "${-parameters}")
+endif ()
+
+file (
+  COPY
+    "${CMAKE_CURRENT_LIST_DIR}/project/CMakeLists.txt"
+    "${CMAKE_CURRENT_LIST_DIR}/project/Hosts.cmake"
+  DESTINATION "${-sourceDir}"
+)
+file (
+  WRITE "${-sourceDir}/DependencyAwareness.yml"
+  "name: scale\n"
+  "version: \"0.1.0\"\n"
+  "dependencies:\n"
+  "  pkg-0:\n"
+  "    require: \">= 1.0.0\"\n"
+  "    location: \"scale:pkg-0\"\n"
+)
+
+set (-indexJson null)
+if (INDEX)
+  _SCALE_BUILD_INDEX(-indexSeconds)
+  set (-indexJson "{ \"seconds\": ${-indexSeconds} }")
+endif ()
+
+_SCALE_CONFIGURE(-coldSeconds cold)
+_SCALE_CONFIGURE(-warmSeconds warm)
+
+file (READ "${-binaryDir}/ResolvedDependencies.cmake" -resolved)
+string (REGEX MATCHALL "DAPPER_USE\\(" -uses "${-resolved}")
+list (LENGTH -uses -resolvedCount)
+
+execute_process (
+  COMMAND "${GIT_EXECUTABLE}" -C "${-dapperDir}" rev-parse HEAD
+  OUTPUT_VARIABLE -revision
+  OUTPUT_STRIP_TRAILING_WHITESPACE
+  ERROR_QUIET
+)
+
+string (
+  CONFIGURE
+[[{
+  "dapperRevision": "@-revision@",
+  "cmakeVersion": "@CMAKE_VERSION@",
+  "gitVersion": "@GIT_VERSION_STRING@",
+  "repositories": @REPOSITORIES@,
+  "tags": @TAGS@,
+  "options": "@OPTIONS@",
+  "index": @-indexJson@,
+  "resolved": @-resolvedCount@,
+  "cold": { "seconds": @-coldSeconds@ },
+  "warm": { "seconds": @-warmSeconds@ }
+}
+]]
+  -json @ONLY
+)
+file (WRITE "${OUTPUT}" "${-json}")
+message (STATUS "Results written to ${OUTPUT}")
@@ -0,0 +1,9 @@
+function (SCALE_HANDLE_SCALE -out)
+  cmake_parse_arguments (PARSE_ARGV 1 -arg "" "HOST;USER;PATH" "")
+  set (
+    "${-out}" "file://${SCALE_REPOSITORIES_DIR}/${-arg_PATH}.git"
+    PARENT_SCOPE
+  )
+endfunction ()
+
+DAPPER_REGISTER_HOST(scale SCALE_HANDLE_SCALE)
@@ -39,14 +39,24 @@ endfunction ()
 
 macro (_DAPPER_FINALIZE_DEPENDENCIES_FOR_CPM -allUsedNames)
   foreach (-name IN ITEMS ${-allUsedNames})
-    CPMDeclarePackage(
-      "${-name}"
-      NAME "${-name}"
-      VERSION "${dapperUse_${-name}_Version}"
-      GIT_REPOSITORY "${dapperUse_${-name}_SourceDir}"
-      GIT_TAG "${dapperUse_${-name}_Revision}"
-      GIT_SHALLOW true
-    )
+    # Exports may have been pruned from the cache since the resolution.
+    if (IS_DIRECTORY "${dapperUse_${-name}_ExportDir}")
+      CPMDeclarePackage(
+        "${-name}"
+        NAME "${-name}"
+        VERSION "${dapperUse_${-name}_Version}"
+        SOURCE_DIR "${dapperUse_${-name}_ExportDir}"
+      )
+    else ()
+      CPMDeclarePackage(
+        "${-name}"
+        NAME "${-name}"
+        VERSION "${dapperUse_${-name}_Version}"
+        GIT_REPOSITORY "${dapperUse_${-name}_SourceDir}"
+        GIT_TAG "${dapperUse_${-name}_Revision}"
+        GIT_SHALLOW true
+      )
+    endif ()
   endforeach ()
 endmacro ()
 
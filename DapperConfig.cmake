@@ -22,13 +22,14 @@ cmake_minimum_required (VERSION 3.18)
 
 function (DAPPER_USE)
   cmake_parse_arguments (
-    PARSE_ARGV 0 -arg "" "NAME;VERSION;SOURCE_DIR;REVISION" ""
+    PARSE_ARGV 0 -arg "" "NAME;VERSION;SOURCE_DIR;REVISION;EXPORT_DIR" ""
   )
 
   set (-name "${-arg_NAME}")
   set ("dapperUse_${-name}_Version" "${-arg_VERSION}" PARENT_SCOPE)
   set ("dapperUse_${-name}_SourceDir" "${-arg_SOURCE_DIR}" PARENT_SCOPE)
   set ("dapperUse_${-name}_Revision" "${-arg_REVISION}" PARENT_SCOPE)
+  set ("dapperUse_${-name}_ExportDir" "${-arg_EXPORT_DIR}" PARENT_SCOPE)
 
   set (-names "${dapperUsedNames}")
   list (APPEND -names "${-name}")
@@ -49,7 +50,7 @@ function (_DAPPER_RESOLVE_DEPENDENCIES -outDepsFile -integration)
     set (-configFile "$ENV{DAPPER_CONFIG_FILE}")
   endif ()
 
-  if (NOT EXISTS "${-depsFile}" OR DAPPER_INSTALL)
+  if (NOT EXISTS "${-depsFile}" OR DAPPER_INSTALL OR DAPPER_UPDATE)
     set (DAPPER_ROOT_DIR "${Dapper_DIR}")
     set (DAPPER_SOURCE_DIR "${CMAKE_CURRENT_SOURCE_DIR}")
     set (DAPPER_BINARY_DIR "${CMAKE_CURRENT_BINARY_DIR}")
@@ -64,6 +65,11 @@ function (_DAPPER_RESOLVE_DEPENDENCIES -outDepsFile -integration)
     DAPPER_INSTALL OFF
     CACHE BOOL "Set ON to invoke the dependency resolution." FORCE
   )
+  set (
+    DAPPER_UPDATE ""
+    CACHE STRING "Names to update on the next resolution, keeping the others."
+    FORCE
+  )
 
   set ("${-outDepsFile}" "${-depsFile}" PARENT_SCOPE)
 endfunction ()
@@ -95,6 +101,69 @@ macro (DAPPER_INTEGRATE_WITH -integration)
   )
 endmacro ()
 
+set (
+  DAPPER_SOLVER_JOBS 1
+  CACHE STRING "Number of solver instances dappi runs in parallel."
+)
+set (
+  DAPPER_FRONTIER_SIZE 2
+  CACHE STRING "DAPs per name walked ahead of their selection. 0 to disable."
+)
+set (
+  DAPPER_LAZY_REVEAL OFF
+  CACHE BOOL "Set ON to peek only version tags which requirements may select."
+)
+set (
+  DAPPER_PARTIAL_CLONE OFF
+  CACHE BOOL "Set ON to clone repositories without blobs if possible."
+)
+set (
+  DAPPER_EXPORT_SOURCES OFF
+  CACHE BOOL "Set ON to share exported sources of the selected revisions."
+)
+set (
+  DAPPER_INDEX_URL ""
+  CACHE STRING "Directory of registry indices named <host>.yml, or file:// URL."
+)
+set (
+  DAPPER_OPTIMIZATION total
+  CACHE STRING "How dappi weighs version penalties: total or stratified."
+)
+set_property (CACHE DAPPER_OPTIMIZATION PROPERTY STRINGS total stratified)
+set (
+  DAPPER_PRIORITIES ""
+  CACHE STRING "Names whose versions are optimized first, in this order."
+)
+set (
+  DAPPER_ENGINE sat
+  CACHE STRING "How dappi searches the selections: sat or pubgrub."
+)
+set_property (CACHE DAPPER_ENGINE PROPERTY STRINGS sat pubgrub)
+set (
+  DAPPER_SIMPLIFY OFF
+  CACHE BOOL "Set ON to let dappi eliminate variables before solving."
+)
+set (
+  DAPPER_TIME_LIMIT ""
+  CACHE STRING "Seconds the resolution may take to optimize. Blank for no limit."
+)
+set (
+  DAPPER_CONFLICT_BUDGET ""
+  CACHE STRING "Conflicts dappi may spend optimizing. Blank for no limit."
+)
+set (
+  DAPPER_SOLVER_STATS OFF
+  CACHE BOOL "Set ON to save statistics of each dappi run into the binary dir."
+)
+set (
+  DAPPER_PROFILE OFF
+  CACHE BOOL "Set ON to save a trace of the resolution into the binary dir."
+)
+set (
+  DAPPER_SERVER ""
+  CACHE STRING "Socket of \"dappi serve\" to run dappi through, if listening."
+)
+
 find_package (Git REQUIRED)
 
 foreach (-component IN LISTS Dapper_FIND_COMPONENTS)
@@ -75,8 +75,18 @@ function (_DAPPER_NEW_DECLARATION -id)
   set_property (GLOBAL APPEND PROPERTY "Dapper::Declarations" "${-id}")
 endfunction ()
 
-function (_DAPPER_LOCK_PREFIX -outPrefix -name)
-  set ("${-outPrefix}" "Dapper::Locks::${-name}::" PARENT_SCOPE)
+# Each root of a workspace has its own lockfile. Locks are kept per root,
+# along with the names it locks and selects.
+function (_DAPPER_LOCK_PREFIX -outPrefix -root -name)
+  set (
+    "${-outPrefix}" "Dapper::Roots::${-root}::Locks::${-name}::" PARENT_SCOPE
+  )
+endfunction ()
+
+function (_DAPPER_ROOT_NAME_PREFIX -outPrefix -root -name)
+  set (
+    "${-outPrefix}" "Dapper::Roots::${-root}::Names::${-name}::" PARENT_SCOPE
+  )
 endfunction ()
 
 function (_DAPPER_DAP_PREFIX -outPrefix -dapId)
@@ -89,6 +99,37 @@ function (_DAPPER_NEW_DAP -dapId)
   set_property (GLOBAL APPEND PROPERTY "Dapper::DAPs" "${-dapId}")
 endfunction ()
 
+# Revisions pointing at the commit of another DAP, under another tag or in a
+# mirror, are aliases of it rather than DAPs of their own.
+function (_DAPPER_NEW_ALIAS -aliasId -dapId)
+  set_property (GLOBAL PROPERTY "Dapper::Aliases::${-aliasId}" "${-dapId}")
+  get_property (-name GLOBAL PROPERTY "Dapper::LockedBy::${-aliasId}")
+  if (NOT -name)
+    return ()
+  endif ()
+  get_property (-roots GLOBAL PROPERTY "Dapper::Roots")
+  foreach (-root IN LISTS -roots)
+    _DAPPER_ROOT_NAME_PREFIX(-rootNamePrefix "${-root}" "${-name}")
+    get_property (
+      -lockedDapId GLOBAL PROPERTY "${-rootNamePrefix}LockedPackage"
+    )
+    if (-lockedDapId STREQUAL -aliasId)
+      set_property (
+        GLOBAL PROPERTY "${-rootNamePrefix}LockedPackage" "${-dapId}"
+      )
+    endif ()
+  endforeach ()
+endfunction ()
+
+function (_DAPPER_CANONICAL_DAP -outDapId -dapId)
+  get_property (-canonical GLOBAL PROPERTY "Dapper::Aliases::${-dapId}")
+  if (-canonical)
+    set ("${-outDapId}" "${-canonical}" PARENT_SCOPE)
+  else ()
+    set ("${-outDapId}" "${-dapId}" PARENT_SCOPE)
+  endif ()
+endfunction ()
+
 function (_DAPPER_NAME_PREFIX -outPrefix -name)
   set ("${-outPrefix}" "Dapper::Names::${-name}::" PARENT_SCOPE)
 endfunction ()
@@ -97,14 +138,19 @@ function (_DAPPER_NEW_NAME -name)
   _DAPPER_NAME_PREFIX(-prefix "${-name}")
   set_property (GLOBAL PROPERTY "${-prefix}KnownPackages" "")
   set_property (GLOBAL APPEND PROPERTY "Dapper::Names" "${-name}")
-  _DAPPER_LOCK_PREFIX(-lockPrefix "${-name}")
-  get_property (-location GLOBAL PROPERTY "${-lockPrefix}Location")
-  if (-location)
-    string (SHA256 -hash "${-location}")
-  else ()
-    set (-hash)
-  endif ()
-  set_property (GLOBAL PROPERTY "${-prefix}LockedPackage" "${-hash}")
+  get_property (-roots GLOBAL PROPERTY "Dapper::Roots")
+  foreach (-root IN LISTS -roots)
+    _DAPPER_LOCK_PREFIX(-lockPrefix "${-root}" "${-name}")
+    get_property (-location GLOBAL PROPERTY "${-lockPrefix}Location")
+    if (-location)
+      string (SHA256 -hash "${-location}")
+      _DAPPER_CANONICAL_DAP(-hash "${-hash}")
+    else ()
+      set (-hash)
+    endif ()
+    _DAPPER_ROOT_NAME_PREFIX(-rootNamePrefix "${-root}" "${-name}")
+    set_property (GLOBAL PROPERTY "${-rootNamePrefix}LockedPackage" "${-hash}")
+  endforeach ()
 endfunction ()
 
 function (_DAPPER_ARRAY_TO_JSON -ret)
@@ -123,22 +169,152 @@ function (_DAPPER_LIST_TO_JSON -ret)
 endfunction ()
 
 function (_DAPPER_KV_PAIRS_TO_JSON -ret)
+  # Popping items one by one would copy the rest of the list each time.
   set (-pairs)
-  while (true)
-    list (LENGTH ARGN -len)
-    if (-len LESS 2)
-      break ()
+  set (-key)
+  set (-isKey true)
+  foreach (-item IN LISTS ARGN)
+    if (-isKey)
+      set (-key "${-item}")
+      set (-isKey false)
+      continue ()
     endif ()
-    list (POP_FRONT ARGN -key)
-    list (POP_FRONT ARGN -jsonValue)
+    set (-jsonValue "${-item}")
     string (CONFIGURE [["@-key@"]] -jsonKey @ONLY ESCAPE_QUOTES)
     string (CONFIGURE [[@-jsonKey@:@-jsonValue@]] -pair @ONLY)
     list (APPEND -pairs "${-pair}")
-  endwhile ()
+    set (-isKey true)
+  endforeach ()
   string (JOIN "," -joinedPairs ${-pairs})
   set (${-ret} "{${-joinedPairs}}" PARENT_SCOPE)
 endfunction ()
 
+function (_DAPPER_NOW -out)
+  # %f is available since CMake 3.23.
+  if (CMAKE_VERSION VERSION_LESS 3.23)
+    string (TIMESTAMP -now "%s" UTC)
+    string (APPEND -now "000000")
+  else ()
+    string (TIMESTAMP -now "%s%f" UTC)
+  endif ()
+  set ("${-out}" "${-now}" PARENT_SCOPE)
+endfunction ()
+
+# Converts seconds, which may have a fraction, to microseconds.
+function (_DAPPER_SECONDS_TO_MICROS -out -seconds)
+  if (NOT -seconds MATCHES "^([0-9]+)(\\.([0-9]*))?$")
+    message (FATAL_ERROR "Invalid number of seconds - ${-seconds}")
+  endif ()
+  set (-whole "${CMAKE_MATCH_1}")
+  string (SUBSTRING "${CMAKE_MATCH_3}000000" 0 6 -fraction)
+  math (EXPR -micros "${-whole} * 1000000 + ${-fraction}")
+  set ("${-out}" "${-micros}" PARENT_SCOPE)
+endfunction ()
+
+function (_DAPPER_MICROS_TO_SECONDS -out -micros)
+  math (EXPR -whole "${-micros} / 1000000")
+  math (EXPR -fraction "${-micros} % 1000000 + 1000000")
+  string (SUBSTRING "${-fraction}" 1 6 -fraction)
+  set ("${-out}" "${-whole}.${-fraction}" PARENT_SCOPE)
+endfunction ()
+
+function (_DAPPER_PROFILE_BEGIN -outBegin)
+  if (DAPPER_PROFILE)
+    _DAPPER_NOW(-now)
+    set ("${-outBegin}" "${-now}" PARENT_SCOPE)
+  endif ()
+endfunction ()
+
+# Records an event started at -begin as a Chrome trace event. PROCESS counts
+# it as a spawned process of the REPOSITORY.
+function (_DAPPER_PROFILE_END -begin -category -name)
+  if (NOT DAPPER_PROFILE)
+    return ()
+  endif ()
+  cmake_parse_arguments (PARSE_ARGV 3 -arg "PROCESS" "REPOSITORY" "")
+  _DAPPER_NOW(-now)
+  math (EXPR -duration "${-now} - ${-begin}")
+
+  string (CONFIGURE [["@-name@"]] -jsonName @ONLY ESCAPE_QUOTES)
+  string (CONFIGURE [["@-category@"]] -jsonCategory @ONLY ESCAPE_QUOTES)
+  set (-jsonArgs)
+  if (DEFINED -arg_REPOSITORY)
+    string (
+      CONFIGURE [[,"args":{"repository":"@-arg_REPOSITORY@"}]]
+      -jsonArgs @ONLY ESCAPE_QUOTES
+    )
+    if (-arg_PROCESS)
+      _DAPPER_PROFILE_COUNT("${-arg_REPOSITORY}" Processes)
+    endif ()
+  endif ()
+  string (
+    CONFIGURE
+      [[{"name":@-jsonName@,"cat":@-jsonCategory@,"ph":"X","ts":@-begin@,"dur":@-duration@,"pid":1,"tid":1@-jsonArgs@}]]
+      -event @ONLY
+  )
+  set_property (GLOBAL APPEND PROPERTY "Dapper::Profile::Events" "${-event}")
+endfunction ()
+
+function (_DAPPER_PROFILE_COUNT -repository -counter)
+  if (NOT DAPPER_PROFILE)
+    return ()
+  endif ()
+  set (-prefix "Dapper::Profile::Repositories::${-repository}::")
+  get_property (-known GLOBAL PROPERTY "${-prefix}Processes" SET)
+  if (NOT -known)
+    set_property (GLOBAL PROPERTY "${-prefix}Processes" 0)
+    set_property (GLOBAL PROPERTY "${-prefix}Iterations" 0)
+    set_property (
+      GLOBAL APPEND PROPERTY "Dapper::Profile::Repositories" "${-repository}"
+    )
+  endif ()
+  get_property (-count GLOBAL PROPERTY "${-prefix}${-counter}")
+  math (EXPR -count "${-count} + 1")
+  set_property (GLOBAL PROPERTY "${-prefix}${-counter}" "${-count}")
+endfunction ()
+
+# Counts the discovery iterations in which the repository is visited.
+function (_DAPPER_PROFILE_VISIT -repository -iteration)
+  if (NOT DAPPER_PROFILE)
+    return ()
+  endif ()
+  set (-prefix "Dapper::Profile::Repositories::${-repository}::")
+  get_property (-last GLOBAL PROPERTY "${-prefix}LastIteration")
+  if (NOT -last STREQUAL -iteration)
+    set_property (GLOBAL PROPERTY "${-prefix}LastIteration" "${-iteration}")
+    _DAPPER_PROFILE_COUNT("${-repository}" Iterations)
+  endif ()
+endfunction ()
+
+function (_DAPPER_PROFILE_WRITE -file)
+  if (NOT DAPPER_PROFILE)
+    return ()
+  endif ()
+  get_property (-events GLOBAL PROPERTY "Dapper::Profile::Events")
+  _DAPPER_ARRAY_TO_JSON(-jsonEvents ${-events})
+
+  set (-repositoryPairs)
+  get_property (-repositories GLOBAL PROPERTY "Dapper::Profile::Repositories")
+  foreach (-repository IN LISTS -repositories)
+    set (-prefix "Dapper::Profile::Repositories::${-repository}::")
+    get_property (-processes GLOBAL PROPERTY "${-prefix}Processes")
+    get_property (-iterations GLOBAL PROPERTY "${-prefix}Iterations")
+    _DAPPER_KV_PAIRS_TO_JSON(
+      -jsonRepository processes "${-processes}" iterations "${-iterations}"
+    )
+    list (APPEND -repositoryPairs "${-repository}" "${-jsonRepository}")
+  endforeach ()
+  _DAPPER_KV_PAIRS_TO_JSON(-jsonRepositories ${-repositoryPairs})
+
+  string (
+    CONFIGURE
+      [[{"traceEvents":@-jsonEvents@,"repositories":@-jsonRepositories@}]]
+      -json @ONLY
+  )
+  file (WRITE "${-file}" "${-json}")
+  message (STATUS "Profile written to ${-file}")
+endfunction ()
+
 function (_DAPPER_VISIT_DAP_INFO)
   cmake_parse_arguments (PARSE_ARGV 0 -arg "" "NAME;VERSION" "")
   _DAPPER_DAP_PREFIX(-prefix "${dapperCurrentPackageId}")
@@ -183,11 +359,15 @@ endfunction ()
 function (_DAPPER_LOAD_DA -dapId -dapDir)
   set (-daFile "${-dapDir}/DependencyAwareness.yml")
   if (EXISTS "${-daFile}")
+    _DAPPER_PROFILE_BEGIN(-begin)
     execute_process (
       COMMAND "${DAPPI_EXECUTABLE}" load -t da -i "${-daFile}" --strict
       RESULT_VARIABLE -code
       OUTPUT_VARIABLE -script
     )
+    _DAPPER_PROFILE_END(
+      "${-begin}" dappi "dappi load -t da" PROCESS REPOSITORY "${-dapDir}"
+    )
     if (NOT -code EQUAL 0)
       message (FATAL_ERROR "dappi load failed.")
     endif ()
@@ -197,11 +377,15 @@ function (_DAPPER_LOAD_DA -dapId -dapDir)
 
     set (-dalFile "${-dapDir}/DependencyAwarenessLock.yml")
     if (EXISTS "${-dalFile}")
+      _DAPPER_PROFILE_BEGIN(-begin)
       execute_process (
         COMMAND "${DAPPI_EXECUTABLE}" load -t dal -i "${-dalFile}" --strict
         RESULT_VARIABLE -code
         OUTPUT_VARIABLE -script
       )
+      _DAPPER_PROFILE_END(
+        "${-begin}" dappi "dappi load -t dal" PROCESS REPOSITORY "${-dapDir}"
+      )
       if (NOT -code EQUAL 0)
         message (FATAL_ERROR "dappi load failed.")
       endif ()
@@ -210,43 +394,297 @@ function (_DAPPER_LOAD_DA -dapId -dapDir)
   endif ()
 endfunction ()
 
-function (_DAPPER_PEEK_DA -dapId -dapDir -tag)
+# Declares DAPs of several revisions of a repository at once. Requests are
+# "<revision>:DependencyAwareness.yml <DAP id>". git reads all the files in one
+# process, and dappi turns them into one script setting every property.
+#
+# Within _DAPPER_PEEK_AHEAD, the requests are deferred and peeked along with
+# those of other repositories instead.
+function (_DAPPER_PEEK_DAS -dapDir -url)
+  if (NOT ARGN)
+    return ()
+  elseif (dapperDeferPeeks)
+    foreach (-request IN LISTS ARGN)
+      set_property (
+        GLOBAL APPEND PROPERTY
+        "Dapper::DeferredPeeks" "${-dapDir}\t${-url}\t${-request}"
+      )
+    endforeach ()
+    return ()
+  endif ()
   string (RANDOM LENGTH 16 -tmpKey)
-  set (-daFile "${CMAKE_CURRENT_BINARY_DIR}/dapper/tmp/${-tmpKey}.yml")
-  file (LOCK "${-daFile}.lock")
+  set (-tmpFile "${CMAKE_CURRENT_BINARY_DIR}/dapper/tmp/${-tmpKey}")
+  file (LOCK "${-tmpFile}.lock")
+  string (JOIN "\n" -requests ${ARGN})
+  file (WRITE "${-tmpFile}.txt" "${-requests}\n")
+  _DAPPER_PROFILE_BEGIN(-begin)
   execute_process (
     COMMAND
       "${GIT_EXECUTABLE}" -C "${-dapDir}"
-      show "${-tag}:DependencyAwareness.yml"
+      cat-file "--batch=%(objectname) %(objecttype) %(objectsize) %(rest)"
     RESULT_VARIABLE -code
-    OUTPUT_FILE "${-daFile}"
+    INPUT_FILE "${-tmpFile}.txt"
+    OUTPUT_FILE "${-tmpFile}.batch"
+  )
+  _DAPPER_PROFILE_END(
+    "${-begin}" git "git cat-file --batch" PROCESS REPOSITORY "${-dapDir}"
   )
   if (-code EQUAL 0)
+    _DAPPER_PROFILE_BEGIN(-begin)
     execute_process (
-      COMMAND "${DAPPI_EXECUTABLE}" load -t da -i "${-daFile}"
+      COMMAND
+        "${DAPPI_EXECUTABLE}" load -t da-batch -i "${-tmpFile}.batch"
+        --requests "${-tmpFile}.txt" --url "${-url}" --source-dir "${-dapDir}"
       RESULT_VARIABLE -code
       OUTPUT_VARIABLE -script
     )
-    file (REMOVE "${-daFile}")
+    _DAPPER_PROFILE_END(
+      "${-begin}" dappi "dappi load -t da-batch" PROCESS REPOSITORY "${-dapDir}"
+    )
     if (-code EQUAL 0)
-      set (dapperCurrentPackageId "${-dapId}")
-      set (dapperCurrentHandler _DAPPER_VISIT)
       cmake_language (EVAL CODE "${-script}")
-      set (-success true)
+      set (-error)
     else ()
-      set (-success false)
+      set (-error "dappi failed.")
     endif ()
   else ()
-    set (-success true) # Just skip it
+    set (-error "git cat-file failed at ${-dapDir}.")
+  endif ()
+  file (REMOVE "${-tmpFile}.txt" "${-tmpFile}.batch")
+  file (LOCK "${-tmpFile}.lock" RELEASE)
+  file (REMOVE "${-tmpFile}.lock")
+  if (-error)
+    message (FATAL_ERROR "${-error}")
+  endif ()
+endfunction ()
+
+# Peeks the requests deferred by _DAPPER_PEEK_DAS in one dappi process, which
+# reads the objects from every repository and parses them concurrently.
+function (_DAPPER_PEEK_DEFERRED)
+  get_property (-requests GLOBAL PROPERTY "Dapper::DeferredPeeks")
+  set_property (GLOBAL PROPERTY "Dapper::DeferredPeeks")
+  if (NOT -requests)
+    return ()
+  endif ()
+  string (RANDOM LENGTH 16 -tmpKey)
+  set (-tmpFile "${CMAKE_CURRENT_BINARY_DIR}/dapper/tmp/${-tmpKey}")
+  file (LOCK "${-tmpFile}.lock")
+  string (JOIN "\n" -lines ${-requests})
+  file (WRITE "${-tmpFile}.txt" "${-lines}\n")
+  _DAPPER_PROFILE_BEGIN(-begin)
+  execute_process (
+    COMMAND
+      "${DAPPI_EXECUTABLE}" load -t da-repos --requests "${-tmpFile}.txt"
+      --git "${GIT_EXECUTABLE}"
+    RESULT_VARIABLE -code
+    OUTPUT_VARIABLE -script
+  )
+  _DAPPER_PROFILE_END("${-begin}" dappi "dappi load -t da-repos")
+  if (DAPPER_PROFILE)
+    foreach (-request IN LISTS -requests)
+      string (FIND "${-request}" "\t" -pos)
+      string (SUBSTRING "${-request}" 0 ${-pos} -dapDir)
+      if (NOT DEFINED "-isCounted::${-dapDir}")
+        set ("-isCounted::${-dapDir}" true)
+        _DAPPER_PROFILE_COUNT("${-dapDir}" Processes)
+      endif ()
+    endforeach ()
+  endif ()
+  file (REMOVE "${-tmpFile}.txt")
+  file (LOCK "${-tmpFile}.lock" RELEASE)
+  file (REMOVE "${-tmpFile}.lock")
+  if (NOT -code EQUAL 0)
+    message (FATAL_ERROR "dappi load failed.")
+  endif ()
+  cmake_language (EVAL CODE "${-script}")
+endfunction ()
+
+# Splits a location into its URL and the arguments of _DAPPER_FETCH for its
+# fragment, if any.
+function (_DAPPER_PARSE_LOCATION -outUrl -outFetchArgs -location)
+  string (REGEX REPLACE "#(.*)$" ";\\1" -parsedLocation "${-location}")
+  list (GET -parsedLocation 0 -url)
+  list (LENGTH -parsedLocation -len)
+  if (-len LESS_EQUAL 1)
+    set (-fetchArgs)
+  else ()
+    list (GET -parsedLocation 1 -fragment)
+    set (-fetchArgs GIT_TAG "${-fragment}")
+  endif ()
+  set ("${-outUrl}" "${-url}" PARENT_SCOPE)
+  set ("${-outFetchArgs}" "${-fetchArgs}" PARENT_SCOPE)
+endfunction ()
+
+# Fetches every location declared by the DAPs as the discovery will, but
+# defers the peeks, so that the revisions of all the repositories are peeked
+# at once. The discovery then finds their DAPs declared.
+function (_DAPPER_PEEK_AHEAD)
+  set (dapperDeferPeeks true)
+  foreach (-dapId IN LISTS ARGN)
+    _DAPPER_DAP_PREFIX(-prefix "${-dapId}")
+    get_property (-declarations GLOBAL PROPERTY "${-prefix}Declarations")
+    foreach (-decl IN LISTS -declarations)
+      _DAPPER_DECLARATION_PREFIX(-declPrefix "${-decl}")
+      get_property (-nameFromDecl GLOBAL PROPERTY "${-declPrefix}Name")
+      get_property (
+        -requiredVersion GLOBAL PROPERTY "${-declPrefix}RequiredVersion"
+      )
+      get_property (
+        -knownLocations GLOBAL PROPERTY "${-declPrefix}KnownLocations"
+      )
+      foreach (-location IN LISTS -knownLocations)
+        _DAPPER_PARSE_LOCATION(-url -fetchArgs "${-location}")
+        _DAPPER_FETCH(
+          -hashes
+          NAME "${-nameFromDecl}"
+          REQUIRE "${-requiredVersion}"
+          GIT_REPOSITORY "${-url}"
+          ${-fetchArgs}
+        )
+      endforeach ()
+    endforeach ()
+  endforeach ()
+  _DAPPER_PEEK_DEFERRED()
+endfunction ()
+
+# Registry indices list the tags of repositories on a host along with their
+# commits, digests and dependencies, so that DAPs are declared without cloning.
+# The index of a host is "<host>.yml" in DAPPER_INDEX_URL, loaded at most once.
+function (_DAPPER_INDEX_PREFIX -outPrefix -location)
+  set ("${-outPrefix}" "" PARENT_SCOPE)
+  if (
+    NOT DAPPER_INDEX_URL
+    OR NOT -location MATCHES [=[^(([^:;@]+)@)?([0-9a-zA-Z_\-\.]+):([^:;]+)$]=]
+  )
+    return ()
+  endif ()
+  set (-host "${CMAKE_MATCH_3}")
+  set (-prefix "Dapper::Index::${-host}:${CMAKE_MATCH_4}::")
+
+  get_property (-loaded GLOBAL PROPERTY "Dapper::Index::${-host}" SET)
+  if (NOT -loaded)
+    set_property (GLOBAL PROPERTY "Dapper::Index::${-host}" true)
+    string (REGEX REPLACE "^file://" "" -indexDir "${DAPPER_INDEX_URL}")
+    set (-indexFile "${-indexDir}/${-host}.yml")
+    if (EXISTS "${-indexFile}")
+      _DAPPER_PROFILE_BEGIN(-begin)
+      execute_process (
+        COMMAND
+          "${DAPPI_EXECUTABLE}" load -t index -i "${-indexFile}"
+          --host "${-host}"
+        RESULT_VARIABLE -code
+        OUTPUT_VARIABLE -script
+      )
+      _DAPPER_PROFILE_END("${-begin}" dappi "dappi load -t index ${-host}")
+      if (NOT -code EQUAL 0)
+        message (FATAL_ERROR "dappi load failed for ${-indexFile}.")
+      endif ()
+      cmake_language (EVAL CODE "${-script}")
+    endif ()
+  endif ()
+
+  get_property (-indexed GLOBAL PROPERTY "${-prefix}Tags" SET)
+  if (-indexed)
+    set ("${-outPrefix}" "${-prefix}" PARENT_SCOPE)
+  endif ()
+endfunction ()
+
+# Declares the DAP of a tag in a registry index, as peeking its
+# DependencyAwareness.yml would.
+function (_DAPPER_DECLARE_INDEXED -dapId -index -url -revision -sourceDir)
+  _DAPPER_DAP_PREFIX(-dapPrefix "${-dapId}")
+  set (-tagPrefix "${-index}${-revision}::")
+  set_property (GLOBAL APPEND PROPERTY "Dapper::DAPs" "${-dapId}")
+  set_property (GLOBAL PROPERTY "${-dapPrefix}URL" "${-url}")
+  set_property (GLOBAL PROPERTY "${-dapPrefix}Fragment" "${-revision}")
+  set_property (GLOBAL PROPERTY "${-dapPrefix}SourceDir" "${-sourceDir}")
+  foreach (-key Commit Digest)
+    get_property (-value GLOBAL PROPERTY "${-tagPrefix}${-key}")
+    set_property (GLOBAL PROPERTY "${-dapPrefix}Indexed${-key}" "${-value}")
+  endforeach ()
+
+  # Tags without awareness are skipped like unreadable ones.
+  set (-declarations)
+  get_property (-count GLOBAL PROPERTY "${-tagPrefix}Dependencies")
+  if (NOT -count STREQUAL "")
+    foreach (-key Name Version)
+      get_property (-value GLOBAL PROPERTY "${-tagPrefix}${-key}")
+      set_property (GLOBAL PROPERTY "${-dapPrefix}${-key}" "${-value}")
+    endforeach ()
+    set (-n 0)
+    while (-n LESS -count)
+      set (-id "${-dapId}_${-n}")
+      set (-depPrefix "${-tagPrefix}Dependency::${-n}::")
+      _DAPPER_NEW_DECLARATION("${-id}")
+      _DAPPER_DECLARATION_PREFIX(-declPrefix "${-id}")
+      set_property (
+        GLOBAL PROPERTY "${-declPrefix}From"
+        "${-url}#${-revision}:DependencyAwareness.yml"
+      )
+      foreach (-key Name RequiredVersion KnownLocations)
+        get_property (-value GLOBAL PROPERTY "${-depPrefix}${-key}")
+        set_property (GLOBAL PROPERTY "${-declPrefix}${-key}" "${-value}")
+      endforeach ()
+      list (APPEND -declarations "${-id}")
+      math (EXPR -n "${-n} + 1")
+    endwhile ()
+  endif ()
+  set_property (GLOBAL PROPERTY "${-dapPrefix}Declarations" "${-declarations}")
+endfunction ()
+
+# Repositories found in registry indices are cloned once anything needs their
+# contents: a selected DAP, or a revision the index does not list.
+function (_DAPPER_ENSURE_CLONE -prefix)
+  get_property (-cloned GLOBAL PROPERTY "${-prefix}Cloned")
+  if (-cloned)
+    return ()
   endif ()
-  file (LOCK "${-daFile}.lock" RELEASE)
-  file (REMOVE "${-daFile}.lock")
-  if (NOT -success)
-    message (FATAL_ERROR "dappi failed.")
+  get_property (-url GLOBAL PROPERTY "${-prefix}URL")
+  get_property (-sourceDir GLOBAL PROPERTY "${-prefix}SourceDir")
+  _DAPPER_CLONE_OR_PULL(-valid "${-url}" "${-sourceDir}")
+  if (NOT -valid)
+    message (FATAL_ERROR "Invalid location - ${-url}")
   endif ()
+  set_property (GLOBAL PROPERTY "${-prefix}Cloned" true)
+endfunction ()
+
+# The digest of a selected DAP declared from a registry index is taken from
+# the index once its clone has the commit the index lists. Returns nothing
+# for other DAPs.
+function (_DAPPER_INDEXED_INTEGRITY -outDigest -dapId)
+  set ("${-outDigest}" "" PARENT_SCOPE)
+  _DAPPER_DAP_PREFIX(-dapPrefix "${-dapId}")
+  get_property (-indexed GLOBAL PROPERTY "${-dapPrefix}IndexedCommit" SET)
+  if (NOT -indexed)
+    return ()
+  endif ()
+  get_property (-url GLOBAL PROPERTY "${-dapPrefix}URL")
+  get_property (-sourceDir GLOBAL PROPERTY "${-dapPrefix}SourceDir")
+  get_property (-revision GLOBAL PROPERTY "${-dapPrefix}Fragment")
+  get_property (-indexedCommit GLOBAL PROPERTY "${-dapPrefix}IndexedCommit")
+  get_property (-indexedDigest GLOBAL PROPERTY "${-dapPrefix}IndexedDigest")
+  string (SHA256 -urlHash "${-url}")
+  _DAPPER_ENSURE_CLONE("Dapper::Repositories::${-urlHash}")
+  execute_process (
+    COMMAND
+      "${GIT_EXECUTABLE}" -C "${-sourceDir}"
+      rev-parse --verify --quiet "${-revision}^{commit}"
+    OUTPUT_VARIABLE -commit
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+  )
+  if (NOT -commit STREQUAL -indexedCommit)
+    message (
+      FATAL_ERROR
+      "The registry index is stale: ${-url}#${-revision} is ${-commit} "
+      "rather than ${-indexedCommit}."
+    )
+  endif ()
+  set ("${-outDigest}" "${-indexedDigest}" PARENT_SCOPE)
 endfunction ()
 
 function (_DAPPER_CALC_INTEGRITY -outDigest -dapDir -revision)
+  _DAPPER_PROFILE_BEGIN(-begin)
   execute_process (
     COMMAND
       "${GIT_EXECUTABLE}" -C "${-dapDir}" ls-tree -r --name-only "${-revision}"
@@ -254,10 +692,15 @@ function (_DAPPER_CALC_INTEGRITY -outDigest -dapDir -revision)
     OUTPUT_VARIABLE -files
     OUTPUT_STRIP_TRAILING_WHITESPACE
   )
+  _DAPPER_PROFILE_END(
+    "${-begin}" git "git ls-tree ${-revision}" PROCESS REPOSITORY "${-dapDir}"
+  )
   if (NOT -code EQUAL 0)
     message (FATAL_ERROR "git ls-tree failed at ${-dapDir}.")
   endif ()
   string (REPLACE "\n" ";" -files "${-files}")
+  list (TRANSFORM -files PREPEND "${-revision}:" OUTPUT_VARIABLE -objects)
+  _DAPPER_PREFETCH_BLOBS("${-dapDir}" ${-objects})
   set (-hashList "")
   foreach (-file IN LISTS -files)
     # To prevent newlines from being converted, we save each file into
@@ -267,18 +710,28 @@ function (_DAPPER_CALC_INTEGRITY -outDigest -dapDir -revision)
     string (RANDOM LENGTH 16 -tmpKey)
     set (-tmpFile "${CMAKE_CURRENT_BINARY_DIR}/dapper/tmp/${-tmpKey}")
     file (LOCK "${-tmpFile}.lock")
+    _DAPPER_PROFILE_BEGIN(-begin)
     execute_process (
       COMMAND "${GIT_EXECUTABLE}" -C "${-dapDir}" show "${-revision}:${-file}"
       RESULT_VARIABLE -code
       OUTPUT_FILE "${-tmpFile}"
     )
+    _DAPPER_PROFILE_END(
+      "${-begin}" git "git show ${-revision}:${-file}"
+      PROCESS REPOSITORY "${-dapDir}"
+    )
     if (-code EQUAL 0)
+      _DAPPER_PROFILE_BEGIN(-begin)
       execute_process (
         COMMAND "${CMAKE_COMMAND}" -E sha512sum "${-tmpFile}"
         RESULT_VARIABLE -code
         OUTPUT_VARIABLE -hash
         OUTPUT_STRIP_TRAILING_WHITESPACE
       )
+      _DAPPER_PROFILE_END(
+        "${-begin}" hash "cmake -E sha512sum ${-file}"
+        PROCESS REPOSITORY "${-dapDir}"
+      )
       file (REMOVE "${-tmpFile}")
       if (-code EQUAL 0)
         string (REGEX REPLACE "  .*$" "" -hash "${-hash}")
@@ -299,6 +752,65 @@ function (_DAPPER_CALC_INTEGRITY -outDigest -dapDir -revision)
   set ("${-outDigest}" "${-digest}" PARENT_SCOPE)
 endfunction ()
 
+# Exports a revision into a directory named after its tree, so identical
+# revisions used by many binary directories share one export. Exports are
+# complete once they exist and never modified afterwards.
+function (_DAPPER_EXPORT_SOURCE -outExportDir -dapDir -revision)
+  execute_process (
+    COMMAND
+      "${GIT_EXECUTABLE}" -C "${-dapDir}" rev-parse "${-revision}^{tree}"
+    RESULT_VARIABLE -code
+    OUTPUT_VARIABLE -tree
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+  )
+  if (NOT -code EQUAL 0)
+    message (FATAL_ERROR "git rev-parse failed at ${-dapDir}.")
+  endif ()
+  get_filename_component (-cacheDir "${DAPPER_REPOSITORIES_DIR}" DIRECTORY)
+  set (-exportDir "${-cacheDir}/sources/${-tree}")
+  set ("${-outExportDir}" "${-exportDir}" PARENT_SCOPE)
+  if (EXISTS "${-exportDir}")
+    return ()
+  endif ()
+
+  file (LOCK "${-exportDir}.lock" GUARD FUNCTION)
+  if (EXISTS "${-exportDir}")
+    return ()
+  endif ()
+  message (STATUS "Exporting ${-dapDir}#${-revision} into ${-exportDir}")
+  string (RANDOM LENGTH 16 -tmpKey)
+  set (-tmpDir "${-exportDir}.tmp-${-tmpKey}")
+  file (MAKE_DIRECTORY "${-tmpDir}")
+  _DAPPER_PROFILE_BEGIN(-begin)
+  execute_process (
+    COMMAND
+      "${GIT_EXECUTABLE}" -C "${-dapDir}" archive --format=tar
+      -o "${-tmpDir}.tar" "${-revision}"
+    RESULT_VARIABLE -code
+  )
+  _DAPPER_PROFILE_END(
+    "${-begin}" git "git archive ${-revision}" PROCESS REPOSITORY "${-dapDir}"
+  )
+  if (-code EQUAL 0)
+    _DAPPER_PROFILE_BEGIN(-begin)
+    execute_process (
+      COMMAND "${CMAKE_COMMAND}" -E tar xf "${-tmpDir}.tar"
+      WORKING_DIRECTORY "${-tmpDir}"
+      RESULT_VARIABLE -code
+    )
+    _DAPPER_PROFILE_END(
+      "${-begin}" export "cmake -E tar ${-revision}"
+      PROCESS REPOSITORY "${-dapDir}"
+    )
+  endif ()
+  file (REMOVE "${-tmpDir}.tar")
+  if (NOT -code EQUAL 0)
+    file (REMOVE_RECURSE "${-tmpDir}")
+    message (FATAL_ERROR "Exporting ${-revision} failed at ${-dapDir}.")
+  endif ()
+  file (RENAME "${-tmpDir}" "${-exportDir}")
+endfunction ()
+
 function (DAPPI_LOCK)
   cmake_parse_arguments (
     PARSE_ARGV 0 -arg "" "NAME;VERSION;LOCATION" "INTEGRITY;DEPENDENCIES"
@@ -311,7 +823,7 @@ function (DAPPI_LOCK)
   else ()
     set (-deps)
   endif ()
-  _DAPPER_LOCK_PREFIX(-lockPrefix "${-arg_NAME}")
+  _DAPPER_LOCK_PREFIX(-lockPrefix "${dapperCurrentPackageId}" "${-arg_NAME}")
   set_property (GLOBAL PROPERTY "${-lockPrefix}Version" "${-arg_VERSION}")
   set_property (GLOBAL PROPERTY "${-lockPrefix}Location" "${-arg_LOCATION}")
   set_property (
@@ -319,10 +831,20 @@ function (DAPPI_LOCK)
   )
   set_property (GLOBAL PROPERTY "${-lockPrefix}Digest" "${-integrity_DIGEST}")
   set_property (GLOBAL PROPERTY "${-lockPrefix}Dependencies" "${-deps}")
+  if (-arg_LOCATION)
+    string (SHA256 -hash "${-arg_LOCATION}")
+    set_property (GLOBAL PROPERTY "Dapper::LockedBy::${-hash}" "${-arg_NAME}")
+  endif ()
+endfunction ()
+
+# Selections apply to the root dappi reported last, if it resolved a
+# workspace.
+function (DAPPI_ROOT -root)
+  set (dappiRoot "${-root}" PARENT_SCOPE)
 endfunction ()
 
 function (DAPPI_SELECT -name -dapId)
-  _DAPPER_NAME_PREFIX(-namePrefix "${-name}")
+  _DAPPER_ROOT_NAME_PREFIX(-namePrefix "${dappiRoot}" "${-name}")
   get_property (-selected GLOBAL PROPERTY "${-namePrefix}SelectedPackage")
   if (NOT -selected STREQUAL -dapId)
     set_property (GLOBAL PROPERTY "${-namePrefix}SelectedPackage" "${-dapId}")
@@ -331,8 +853,18 @@ function (DAPPI_SELECT -name -dapId)
   endif ()
 endfunction ()
 
+function (DAPPI_FRONTIER -dapId)
+  set (-frontier "${dappiFrontier}")
+  list (APPEND -frontier "${-dapId}")
+  set (dappiFrontier "${-frontier}" PARENT_SCOPE)
+endfunction ()
+
+function (DAPPI_NONOPTIMAL)
+  set (dappiNonOptimal true PARENT_SCOPE)
+endfunction ()
+
 function (DAPPI_UNSELECT -name)
-  _DAPPER_NAME_PREFIX(-namePrefix "${-name}")
+  _DAPPER_ROOT_NAME_PREFIX(-namePrefix "${dappiRoot}" "${-name}")
   get_property (-selected GLOBAL PROPERTY "${-namePrefix}SelectedPackage")
   if (-selected)
     set_property (GLOBAL PROPERTY "${-namePrefix}SelectedPackage" false)
@@ -340,8 +872,13 @@ function (DAPPI_UNSELECT -name)
   endif ()
 endfunction ()
 
+# Repositories may be shared by concurrent configurations. They are only
+# modified under a lock, while reading them needs none: git updates refs
+# atomically, and clones appear by renaming a complete repository into place.
+# Every synchronization bumps the generation of the repository and records
+# when it began, so processes which waited for it, or began resolving before
+# it, do not synchronize again.
 function (_DAPPER_CLONE_OR_PULL -out -url -sourceDir)
-  file (LOCK "${-sourceDir}.lock" GUARD FUNCTION)
   _DAPPER_RESOLVE_LOCATION(-url "${-url}")
 
   if (NOT -url)
@@ -349,8 +886,31 @@ function (_DAPPER_CLONE_OR_PULL -out -url -sourceDir)
     return ()
   endif ()
 
-  if (EXISTS "${-sourceDir}")
+  _DAPPER_READ_GENERATION(-generation "${-sourceDir}")
+  _DAPPER_PROFILE_BEGIN(-begin)
+  file (LOCK "${-sourceDir}.lock" GUARD FUNCTION)
+  _DAPPER_PROFILE_END(
+    "${-begin}" lock "file lock" REPOSITORY "${-sourceDir}"
+  )
+  _DAPPER_READ_GENERATION(-lockedGeneration "${-sourceDir}")
+
+  set (-synchronized false)
+  if (NOT -generation STREQUAL -lockedGeneration)
+    set (-synchronized true)
+  elseif (-lockedGeneration MATCHES ";([0-9]+)$")
+    get_property (-resolveBegin GLOBAL PROPERTY "Dapper::ResolveBegin")
+    if (NOT CMAKE_MATCH_1 LESS -resolveBegin)
+      set (-synchronized true)
+    endif ()
+  endif ()
+
+  _DAPPER_NOW(-synchronizationBegin)
+  if (-synchronized)
+    message (STATUS "${-sourceDir} was synchronized by another process")
+    set (-clone false)
+  elseif (EXISTS "${-sourceDir}")
     message (STATUS "Validating ${-sourceDir}")
+    _DAPPER_PROFILE_BEGIN(-begin)
     execute_process (
       COMMAND
         "${GIT_EXECUTABLE}"
@@ -358,124 +918,551 @@ function (_DAPPER_CLONE_OR_PULL -out -url -sourceDir)
         fsck --connectivity-only --no-dangling
       RESULT_VARIABLE -code
     )
+    _DAPPER_PROFILE_END(
+      "${-begin}" git "git fsck" PROCESS REPOSITORY "${-sourceDir}"
+    )
     if (-code EQUAL 0)
       message (STATUS "Synchronizing ${-sourceDir} with ${-url}")
+      _DAPPER_PROFILE_BEGIN(-begin)
       execute_process (
         COMMAND "${GIT_EXECUTABLE}" -C "${-sourceDir}" fetch --all --tags
         RESULT_VARIABLE -code
         ERROR_QUIET
         OUTPUT_QUIET
       )
+      _DAPPER_PROFILE_END(
+        "${-begin}" git "git fetch" PROCESS REPOSITORY "${-sourceDir}"
+      )
       if (NOT -code EQUAL 0)
         message (FATAL_ERROR "git fetch failed.")
       endif ()
-      set (-clone false)
-    else ()
-      message (STATUS "A broken repository found. Cleaning up...")
-      file (REMOVE_RECURSE "${-sourceDir}")
-      set (-clone true)
-    endif ()
-  else ()
-    set (-clone true)
+      list (GET -lockedGeneration 0 -number)
+      math (EXPR -number "${-number} + 1")
+      _DAPPER_WRITE_GENERATION(
+        "${-sourceDir}" "${-number};${-synchronizationBegin}"
+      )
+      set (-clone false)
+    else ()
+      message (STATUS "A broken repository found. Cleaning up...")
+      # Moved aside rather than removed, as other processes may still be
+      # reading it. Clones of later runs sweep it up.
+      string (RANDOM LENGTH 16 -tmpKey)
+      set (-brokenDir "${-sourceDir}.tmp-${-tmpKey}")
+      file (RENAME "${-sourceDir}" "${-brokenDir}")
+      set (-clone true)
+    endif ()
+  else ()
+    set (-clone true)
+  endif ()
+
+  set (-partial false)
+  if (-clone)
+    # Leftovers of interrupted clones or cleanups of earlier runs
+    file (GLOB -leftovers LIST_DIRECTORIES true "${-sourceDir}.tmp-*")
+    if (-leftovers AND DEFINED -brokenDir)
+      list (REMOVE_ITEM -leftovers "${-brokenDir}")
+    endif ()
+    if (-leftovers)
+      file (REMOVE_RECURSE ${-leftovers})
+    endif ()
+    string (RANDOM LENGTH 16 -tmpKey)
+    set (-cloneDir "${-sourceDir}.tmp-${-tmpKey}")
+    set (-cloned false)
+  endif ()
+
+  if (-clone AND DAPPER_PARTIAL_CLONE)
+    message (STATUS "Cloning ${-url} into ${-sourceDir} without blobs")
+    _DAPPER_PROFILE_BEGIN(-begin)
+    execute_process (
+      COMMAND
+        "${GIT_EXECUTABLE}" clone --bare --filter=blob:none
+        "${-url}" "${-cloneDir}"
+      RESULT_VARIABLE -code
+      ERROR_QUIET
+      OUTPUT_QUIET
+    )
+    _DAPPER_PROFILE_END(
+      "${-begin}" git "git clone --filter" PROCESS REPOSITORY "${-sourceDir}"
+    )
+    if (-code EQUAL 0)
+      _DAPPER_CHECK_PARTIAL_CLONE(-partial "${-cloneDir}")
+      set (-cloned true)
+    else ()
+      message (STATUS "Partial clone failed. Falling back to a full clone...")
+      file (REMOVE_RECURSE "${-cloneDir}")
+      set (-cloned false)
+    endif ()
+  elseif (DAPPER_PARTIAL_CLONE)
+    execute_process (
+      COMMAND
+        "${GIT_EXECUTABLE}" -C "${-sourceDir}"
+        config --get remote.origin.partialclonefilter
+      OUTPUT_VARIABLE -filter
+      ERROR_QUIET
+    )
+    if (-filter)
+      set (-partial true)
+    endif ()
+  endif ()
+
+  if (-clone AND NOT -cloned)
+    message (STATUS "Cloning ${-url} into ${-sourceDir}")
+    _DAPPER_PROFILE_BEGIN(-begin)
+    execute_process (
+      COMMAND "${GIT_EXECUTABLE}" clone --bare "${-url}" "${-cloneDir}"
+      RESULT_VARIABLE -code
+      ERROR_QUIET
+      OUTPUT_QUIET
+    )
+    _DAPPER_PROFILE_END(
+      "${-begin}" git "git clone" PROCESS REPOSITORY "${-sourceDir}"
+    )
+    if (NOT -code EQUAL 0)
+      file (REMOVE_RECURSE "${-cloneDir}")
+      message (FATAL_ERROR "git clone failed.")
+    endif ()
+  endif ()
+  if (-clone)
+    _DAPPER_WRITE_GENERATION("${-cloneDir}" "1;${-synchronizationBegin}")
+    file (RENAME "${-cloneDir}" "${-sourceDir}")
+  endif ()
+  set_property (
+    GLOBAL PROPERTY "Dapper::PartialClones::${-sourceDir}" "${-partial}"
+  )
+  set ("${-out}" true PARENT_SCOPE)
+endfunction ()
+
+# A generation is a list of its number and when its synchronization began.
+# Repositories cloned before generations were introduced are generation 0.
+function (_DAPPER_READ_GENERATION -out -sourceDir)
+  if (EXISTS "${-sourceDir}/dapper-generation")
+    file (READ "${-sourceDir}/dapper-generation" -generation)
+    string (STRIP "${-generation}" -generation)
+  elseif (EXISTS "${-sourceDir}")
+    set (-generation 0)
+  else ()
+    set (-generation "")
+  endif ()
+  set ("${-out}" "${-generation}" PARENT_SCOPE)
+endfunction ()
+
+# Only called under the repository lock
+function (_DAPPER_WRITE_GENERATION -sourceDir -generation)
+  file (WRITE "${-sourceDir}/dapper-generation.tmp" "${-generation}\n")
+  file (
+    RENAME
+    "${-sourceDir}/dapper-generation.tmp"
+    "${-sourceDir}/dapper-generation"
+  )
+endfunction ()
+
+# Remotes which do not support filters send every blob anyway. Such clones
+# are turned into regular ones, so that blobs are never prefetched for them.
+function (_DAPPER_CHECK_PARTIAL_CLONE -out -sourceDir)
+  execute_process (
+    COMMAND
+      "${GIT_EXECUTABLE}" -C "${-sourceDir}"
+      rev-list --objects --missing=print --max-count=1 --all
+    OUTPUT_VARIABLE -objects
+    ERROR_QUIET
+  )
+  if (-objects MATCHES "(^|\n)\\?")
+    set ("${-out}" true PARENT_SCOPE)
+  else ()
+    foreach (-key remote.origin.promisor remote.origin.partialclonefilter)
+      execute_process (
+        COMMAND "${GIT_EXECUTABLE}" -C "${-sourceDir}" config --unset "${-key}"
+        ERROR_QUIET
+      )
+    endforeach ()
+    set ("${-out}" false PARENT_SCOPE)
+  endif ()
+endfunction ()
+
+# Fetches missing blobs of a partial clone in one go, rather than letting git
+# fetch them one by one on demand. Objects are given as "<revision>:<path>".
+# Anything this fails to fetch is still fetched on demand.
+function (_DAPPER_PREFETCH_BLOBS -sourceDir)
+  get_property (
+    -partial GLOBAL PROPERTY "Dapper::PartialClones::${-sourceDir}"
+  )
+  if (NOT -partial OR NOT ARGN)
+    return ()
+  endif ()
+
+  string (RANDOM LENGTH 16 -tmpKey)
+  set (-tmpFile "${CMAKE_CURRENT_BINARY_DIR}/dapper/tmp/${-tmpKey}.txt")
+  string (JOIN "\n" -objects ${ARGN})
+  file (WRITE "${-tmpFile}" "${-objects}\n")
+
+  # Asking only names does not make git read, thus fetch, the blobs.
+  _DAPPER_PROFILE_BEGIN(-begin)
+  execute_process (
+    COMMAND
+      "${GIT_EXECUTABLE}" -C "${-sourceDir}"
+      cat-file "--batch-check=%(objectname)"
+    INPUT_FILE "${-tmpFile}"
+    OUTPUT_VARIABLE -oids
+    RESULT_VARIABLE -code
+  )
+  _DAPPER_PROFILE_END(
+    "${-begin}" git "git cat-file --batch-check"
+    PROCESS REPOSITORY "${-sourceDir}"
+  )
+  string (REPLACE "\n" ";" -oids "${-oids}")
+  list (FILTER -oids INCLUDE REGEX "^[0-9a-f]+$")
+
+  if (-code EQUAL 0 AND -oids)
+    string (JOIN "\n" -oids ${-oids})
+    file (WRITE "${-tmpFile}" "${-oids}\n")
+    _DAPPER_PROFILE_BEGIN(-begin)
+    execute_process (
+      COMMAND
+        "${GIT_EXECUTABLE}" -C "${-sourceDir}"
+        -c fetch.negotiationAlgorithm=noop
+        fetch origin --no-tags --no-write-fetch-head --recurse-submodules=no
+        --filter=blob:none --stdin
+      INPUT_FILE "${-tmpFile}"
+      ERROR_QUIET
+      OUTPUT_QUIET
+    )
+    _DAPPER_PROFILE_END(
+      "${-begin}" git "git fetch --stdin" PROCESS REPOSITORY "${-sourceDir}"
+    )
+  endif ()
+  file (REMOVE "${-tmpFile}")
+endfunction ()
+
+# Exposes hidden revisions which the requirement may select, along with the
+# revisions locked for the name by any root.
+function (_DAPPER_REVEAL -outExposed -exposed -prefix -url -name -require)
+  get_property (-hidden GLOBAL PROPERTY "${-prefix}HiddenRevisions")
+  if (NOT -hidden)
+    set ("${-outExposed}" "${-exposed}" PARENT_SCOPE)
+    return ()
+  endif ()
+
+  set (-revealed)
+  if (-name)
+    get_property (-roots GLOBAL PROPERTY "Dapper::Roots")
+    string (LENGTH "${-url}#" -urlLength)
+    foreach (-root IN LISTS -roots)
+      _DAPPER_LOCK_PREFIX(-lockPrefix "${-root}" "${-name}")
+      get_property (-location GLOBAL PROPERTY "${-lockPrefix}Location")
+      string (SUBSTRING "${-location}" 0 ${-urlLength} -lockedUrl)
+      if (-lockedUrl STREQUAL "${-url}#")
+        string (SUBSTRING "${-location}" ${-urlLength} -1 -lockedRevision)
+        get_property (
+          -isHidden GLOBAL PROPERTY "${-prefix}Hidden::${-lockedRevision}"
+        )
+        if (-isHidden)
+          list (APPEND -revealed "${-lockedRevision}")
+        endif ()
+      endif ()
+    endforeach ()
   endif ()
 
-  if (-clone)
-    message (STATUS "Cloning ${-url} into ${-sourceDir}")
+  get_property (
+    -isRevealed GLOBAL PROPERTY "${-prefix}RevealedRange::${-require}" SET
+  )
+  if (-require STREQUAL "" OR -require STREQUAL "*")
+    list (APPEND -revealed ${-hidden})
+  elseif (NOT -isRevealed)
+    _DAPPER_PROFILE_BEGIN(-begin)
     execute_process (
-      COMMAND "${GIT_EXECUTABLE}" clone --bare "${-url}" "${-sourceDir}"
+      COMMAND "${DAPPI_EXECUTABLE}" match -r "${-require}" ${-hidden}
       RESULT_VARIABLE -code
-      ERROR_QUIET
-      OUTPUT_QUIET
+      OUTPUT_VARIABLE -matched
+    )
+    get_property (-sourceDir GLOBAL PROPERTY "${-prefix}SourceDir")
+    _DAPPER_PROFILE_END(
+      "${-begin}" dappi "dappi match" PROCESS REPOSITORY "${-sourceDir}"
     )
     if (NOT -code EQUAL 0)
-      message (FATAL_ERROR "git clone failed.")
+      message (FATAL_ERROR "dappi match failed for ${-url}.")
     endif ()
+    string (REPLACE "\n" ";" -matched "${-matched}")
+    list (REMOVE_ITEM -matched "")
+    list (APPEND -revealed ${-matched})
+    set_property (GLOBAL PROPERTY "${-prefix}RevealedRange::${-require}" true)
   endif ()
-  set ("${-out}" true PARENT_SCOPE)
+
+  if (-revealed)
+    foreach (-revision IN LISTS -exposed)
+      set ("-isExposed::${-revision}" true)
+    endforeach ()
+    foreach (-revision IN LISTS -revealed)
+      set_property (GLOBAL PROPERTY "${-prefix}Hidden::${-revision}" false)
+      if (NOT DEFINED "-isExposed::${-revision}")
+        set ("-isExposed::${-revision}" true)
+        list (APPEND -exposed "${-revision}")
+      endif ()
+    endforeach ()
+    set (-stillHidden)
+    foreach (-revision IN LISTS -hidden)
+      get_property (-isHidden GLOBAL PROPERTY "${-prefix}Hidden::${-revision}")
+      if (-isHidden)
+        list (APPEND -stillHidden "${-revision}")
+      endif ()
+    endforeach ()
+    set_property (
+      GLOBAL PROPERTY "${-prefix}HiddenRevisions" "${-stillHidden}"
+    )
+  endif ()
+  set_property (GLOBAL PROPERTY "${-prefix}ExposedRevisions" "${-exposed}")
+  set ("${-outExposed}" "${-exposed}" PARENT_SCOPE)
 endfunction ()
 
 function (_DAPPER_FETCH -outHashes)
-  cmake_parse_arguments (PARSE_ARGV 1 -arg "" "NAME;GIT_REPOSITORY;GIT_TAG" "")
+  cmake_parse_arguments (
+    PARSE_ARGV 1 -arg "" "NAME;REQUIRE;GIT_REPOSITORY;GIT_TAG" ""
+  )
   string (SHA256 -urlHash "${-arg_GIT_REPOSITORY}")
   set (-prefix "Dapper::Repositories::${-urlHash}")
 
-  get_property (-repositories GLOBAL PROPERTY "Dapper::Repositories")
-  if (-urlHash IN_LIST -repositories)
+  get_property (-known GLOBAL PROPERTY "${-prefix}SourceDir" SET)
+  if (-known)
     get_property (-sourceDir GLOBAL PROPERTY "${-prefix}SourceDir")
+    get_property (-indexPrefix GLOBAL PROPERTY "${-prefix}IndexPrefix")
     get_property (-exposed GLOBAL PROPERTY "${-prefix}ExposedRevisions")
     if (DEFINED -arg_GIT_TAG AND NOT "${-arg_GIT_TAG}" IN_LIST -exposed)
       list (APPEND -exposed "${-arg_GIT_TAG}")
     endif ()
   else ()
     set (-sourceDir "${DAPPER_REPOSITORIES_DIR}/${-urlHash}")
-    _DAPPER_CLONE_OR_PULL(-valid "${-arg_GIT_REPOSITORY}" "${-sourceDir}")
+    set_property (GLOBAL PROPERTY "${-prefix}URL" "${-arg_GIT_REPOSITORY}")
+    set_property (GLOBAL PROPERTY "${-prefix}SourceDir" "${-sourceDir}")
+    _DAPPER_INDEX_PREFIX(-indexPrefix "${-arg_GIT_REPOSITORY}")
+    set_property (GLOBAL PROPERTY "${-prefix}IndexPrefix" "${-indexPrefix}")
+    if (-indexPrefix)
+      set (-valid true)
+    else ()
+      _DAPPER_CLONE_OR_PULL(-valid "${-arg_GIT_REPOSITORY}" "${-sourceDir}")
+      set_property (GLOBAL PROPERTY "${-prefix}Cloned" "${-valid}")
+    endif ()
 
     set (-exposed)
-    if (-valid)
+    if (-indexPrefix)
+      get_property (-tags GLOBAL PROPERTY "${-indexPrefix}Tags")
+      foreach (-tag IN LISTS -tags)
+        get_property (-commit GLOBAL PROPERTY "${-indexPrefix}${-tag}::Commit")
+        set_property (GLOBAL PROPERTY "${-prefix}Commit::${-tag}" "${-commit}")
+      endforeach ()
+    elseif (-valid)
+      # Tags are listed with the commits they point at, peeling annotated
+      # ones, so that DAPs of the same commit can be told apart without
+      # another process.
+      _DAPPER_PROFILE_BEGIN(-begin)
       execute_process (
         COMMAND
-          "${GIT_EXECUTABLE}" -C "${-sourceDir}" tag
+          "${GIT_EXECUTABLE}" -C "${-sourceDir}" for-each-ref
+          "--format=%(refname:strip=2) %(objectname) %(*objectname)"
+          refs/tags
         OUTPUT_VARIABLE
-          -tags
+          -refs
+      )
+      _DAPPER_PROFILE_END(
+        "${-begin}" git "git for-each-ref" PROCESS REPOSITORY "${-sourceDir}"
       )
-      string (REPLACE "\n" ";" -tags "${-tags}")
-      list (REMOVE_ITEM -tags "")
+      string (REPLACE "\n" ";" -refs "${-refs}")
+      set (-tags)
+      foreach (-ref IN LISTS -refs)
+        if (-ref MATCHES "^([^ ]+) ([0-9a-f]+) ([0-9a-f]*)$")
+          set (-tag "${CMAKE_MATCH_1}")
+          set (-commit "${CMAKE_MATCH_3}")
+          if (NOT -commit)
+            set (-commit "${CMAKE_MATCH_2}")
+          endif ()
+          list (APPEND -tags "${-tag}")
+          set_property (
+            GLOBAL PROPERTY "${-prefix}Commit::${-tag}" "${-commit}"
+          )
+        endif ()
+      endforeach ()
+    endif ()
 
+    if (-valid)
       foreach (-tag IN LISTS -tags)
         # Ignoring pre-releases right now
         if (-tag MATCHES "^v[0-9]+(\\.[0-9]+)?(\\.[0-9]+)?(\\.[0-9]+)?$")
           list (APPEND -exposed "${-tag}")
         endif ()
       endforeach ()
+      # Version tags stay hidden until any requirement may select them.
+      if (DAPPER_LAZY_REVEAL)
+        set_property (
+          GLOBAL PROPERTY "${-prefix}HiddenRevisions" "${-exposed}"
+        )
+        foreach (-tag IN LISTS -exposed)
+          set_property (GLOBAL PROPERTY "${-prefix}Hidden::${-tag}" true)
+        endforeach ()
+        set (-exposed)
+      endif ()
       if (DEFINED -arg_GIT_TAG)
         list (APPEND -exposed "${-arg_GIT_TAG}")
       endif ()
       list (REMOVE_DUPLICATES -exposed)
     endif ()
 
-    set_property (GLOBAL PROPERTY "${-prefix}URL" "${-arg_GIT_REPOSITORY}")
-    set_property (GLOBAL PROPERTY "${-prefix}SourceDir" "${-sourceDir}")
     set_property (GLOBAL PROPERTY "${-prefix}ExposedRevisions" "${-exposed}")
     set_property (GLOBAL APPEND PROPERTY "Dapper::Repositories" "${-urlHash}")
   endif ()
 
-  set (-hashes)
+  if (DAPPER_LAZY_REVEAL)
+    _DAPPER_REVEAL(
+      -exposed
+      "${-exposed}"
+      "${-prefix}"
+      "${-arg_GIT_REPOSITORY}"
+      "${-arg_NAME}"
+      "${-arg_REQUIRE}"
+    )
+  endif ()
+
+  _DAPPER_PROFILE_VISIT("${-sourceDir}" "${-iteration}")
+
+  # Locked revisions are canonicalized first, so that they stay the DAPs
+  # of their commits rather than becoming aliases.
+  set (-lockedRevisions)
+  set (-otherRevisions)
   foreach (-revision IN LISTS -exposed)
     string (SHA256 -hash "${-arg_GIT_REPOSITORY}#${-revision}")
-    get_property (-daps GLOBAL PROPERTY "Dapper::DAPs")
-    if (NOT -hash IN_LIST -daps)
-      _DAPPER_NEW_DAP("${-hash}")
-      _DAPPER_PEEK_DA("${-hash}" "${-sourceDir}" "${-revision}")
+    get_property (-locked GLOBAL PROPERTY "Dapper::LockedBy::${-hash}" SET)
+    if (-locked)
+      list (APPEND -lockedRevisions "${-revision}")
+    else ()
+      list (APPEND -otherRevisions "${-revision}")
+    endif ()
+  endforeach ()
 
-      _DAPPER_DAP_PREFIX(-dapPrefix "${-hash}")
-      set_property (GLOBAL PROPERTY "${-dapPrefix}URL" "${-arg_GIT_REPOSITORY}")
-      set_property (GLOBAL PROPERTY "${-dapPrefix}Fragment" "${-revision}")
-      set_property (GLOBAL PROPERTY "${-dapPrefix}SourceDir" "${-sourceDir}")
+  set (-newObjects)
+  set (-requests)
+  foreach (-revision IN LISTS -lockedRevisions -otherRevisions)
+    string (SHA256 -hash "${-arg_GIT_REPOSITORY}#${-revision}")
+    _DAPPER_CANONICAL_DAP(-dapId "${-hash}")
+    _DAPPER_DAP_PREFIX(-dapPrefix "${-dapId}")
+    get_property (-known GLOBAL PROPERTY "${-dapPrefix}Declarations" SET)
+    if (NOT -known)
+      # Deferred peeks declare the DAP later.
+      get_property (-known GLOBAL PROPERTY "${-dapPrefix}Peeking" SET)
+    endif ()
+    if (NOT -known)
+      set (-indexed false)
+      if (-indexPrefix)
+        get_property (
+          -indexed GLOBAL PROPERTY "${-indexPrefix}${-revision}::Commit" SET
+        )
+      endif ()
+      if (NOT -indexed)
+        _DAPPER_ENSURE_CLONE("${-prefix}")
+      endif ()
+      _DAPPER_REVISION_COMMIT(
+        -commit "${-prefix}" "${-sourceDir}" "${-revision}"
+      )
+      if (-commit)
+        get_property (-dapId GLOBAL PROPERTY "Dapper::Commits::${-commit}")
+      else ()
+        set (-dapId)
+      endif ()
+      if (-dapId)
+        _DAPPER_NEW_ALIAS("${-hash}" "${-dapId}")
+      else ()
+        set (-dapId "${-hash}")
+        if (-commit)
+          set_property (
+            GLOBAL PROPERTY "Dapper::Commits::${-commit}" "${-hash}"
+          )
+        endif ()
+        if (-indexed)
+          _DAPPER_DECLARE_INDEXED(
+            "${-hash}"
+            "${-indexPrefix}"
+            "${-arg_GIT_REPOSITORY}"
+            "${-revision}"
+            "${-sourceDir}"
+          )
+        else ()
+          set_property (GLOBAL PROPERTY "${-dapPrefix}Peeking" true)
+          list (APPEND -newObjects "${-revision}:DependencyAwareness.yml")
+          list (
+            APPEND -requests "${-revision}:DependencyAwareness.yml ${-hash}"
+          )
+        endif ()
+      endif ()
     endif ()
-    list (APPEND -hashes "${-hash}")
   endforeach ()
+  _DAPPER_PREFETCH_BLOBS("${-sourceDir}" ${-newObjects})
+  _DAPPER_PEEK_DAS("${-sourceDir}" "${-arg_GIT_REPOSITORY}" ${-requests})
 
+  set (-hashes)
+  foreach (-revision IN LISTS -exposed)
+    string (SHA256 -hash "${-arg_GIT_REPOSITORY}#${-revision}")
+    _DAPPER_CANONICAL_DAP(-dapId "${-hash}")
+    if (NOT DEFINED "-isListed::${-dapId}")
+      set ("-isListed::${-dapId}" true)
+      list (APPEND -hashes "${-dapId}")
+    endif ()
+  endforeach ()
   set (${-outHashes} "${-hashes}" PARENT_SCOPE)
 endfunction ()
 
-function (_DAPPER_BUILD_JSON -outJson -allNames -allDaps)
+# Commits of tags are known from listing them. Other revisions, like branches
+# given as fragments of locations, are looked up once.
+function (_DAPPER_REVISION_COMMIT -outCommit -prefix -sourceDir -revision)
+  get_property (-known GLOBAL PROPERTY "${-prefix}Commit::${-revision}" SET)
+  if (NOT -known)
+    _DAPPER_PROFILE_BEGIN(-begin)
+    execute_process (
+      COMMAND
+        "${GIT_EXECUTABLE}" -C "${-sourceDir}"
+        rev-parse --verify --quiet "${-revision}^{commit}"
+      OUTPUT_VARIABLE -commit
+      OUTPUT_STRIP_TRAILING_WHITESPACE
+      ERROR_QUIET
+    )
+    _DAPPER_PROFILE_END(
+      "${-begin}" git "git rev-parse ${-revision}"
+      PROCESS REPOSITORY "${-sourceDir}"
+    )
+    set_property (GLOBAL PROPERTY "${-prefix}Commit::${-revision}" "${-commit}")
+  endif ()
+  get_property (-commit GLOBAL PROPERTY "${-prefix}Commit::${-revision}")
+  set ("${-outCommit}" "${-commit}" PARENT_SCOPE)
+endfunction ()
+
+# A single root is the entry of the problem, with its selections and locks
+# kept in the names. Several roots are listed along with their locks instead.
+function (_DAPPER_BUILD_JSON -outJson -roots -allNames -allDaps)
+  foreach (-name IN LISTS -allNames)
+    set ("-isRelevant::${-name}" true)
+  endforeach ()
+  list (LENGTH -roots -numRoots)
+
+  list (LENGTH DAPPER_PRIORITIES -numPriorities)
   set (-namePairs)
   foreach (-name IN LISTS -allNames)
     _DAPPER_NAME_PREFIX(-namePrefix "${-name}")
     set (-members)
 
-    get_property (
-      -selectedDapId GLOBAL PROPERTY "${-namePrefix}SelectedPackage"
-    )
-    if (-selectedDapId)
-      string (CONFIGURE [["@-selectedDapId@"]] -jsonDapId @ONLY ESCAPE_QUOTES)
-      list (APPEND -members selected "${-jsonDapId}")
-    endif ()
+    if (-numRoots EQUAL 1)
+      _DAPPER_ROOT_NAME_PREFIX(-rootNamePrefix "${-roots}" "${-name}")
+      get_property (
+        -selectedDapId GLOBAL PROPERTY "${-rootNamePrefix}SelectedPackage"
+      )
+      if (-selectedDapId)
+        string (
+          CONFIGURE [["@-selectedDapId@"]] -jsonDapId @ONLY ESCAPE_QUOTES
+        )
+        list (APPEND -members selected "${-jsonDapId}")
+      endif ()
 
-    get_property (-lockedDapId GLOBAL PROPERTY "${-namePrefix}LockedPackage")
-    if (-lockedDapId)
-      string (CONFIGURE [["@-lockedDapId@"]] -jsonDapId @ONLY ESCAPE_QUOTES)
-      list (APPEND -members locked "${-jsonDapId}")
+      get_property (
+        -lockedDapId GLOBAL PROPERTY "${-rootNamePrefix}LockedPackage"
+      )
+      if (-lockedDapId)
+        string (CONFIGURE [["@-lockedDapId@"]] -jsonDapId @ONLY ESCAPE_QUOTES)
+        list (APPEND -members locked "${-jsonDapId}")
+      endif ()
     endif ()
 
     get_property (-knownDapIds GLOBAL PROPERTY "${-namePrefix}KnownPackages")
@@ -483,6 +1470,13 @@ function (_DAPPER_BUILD_JSON -outJson -allNames -allDaps)
     _DAPPER_LIST_TO_JSON(-jsonKnown ${-knownDapIds})
     list (APPEND -members known "${-jsonKnown}")
 
+    # The first one in DAPPER_PRIORITIES gets the highest priority.
+    list (FIND DAPPER_PRIORITIES "${-name}" -index)
+    if (-index GREATER_EQUAL 0)
+      math (EXPR -priority "${-numPriorities} - ${-index}")
+      list (APPEND -members priority "${-priority}")
+    endif ()
+
     _DAPPER_KV_PAIRS_TO_JSON(-jsonName ${-members})
     list (APPEND -namePairs "${-name}" "${-jsonName}")
   endforeach ()
@@ -525,7 +1519,7 @@ function (_DAPPER_BUILD_JSON -outJson -allNames -allDaps)
     foreach (-decl IN LISTS -declarations)
       _DAPPER_DECLARATION_PREFIX(-declPrefix "${-decl}")
       get_property (-name GLOBAL PROPERTY "${-declPrefix}Name")
-      if (-name IN_LIST -allNames)
+      if (DEFINED "-isRelevant::${-name}")
         get_property (
           -requiredVersion GLOBAL PROPERTY "${-declPrefix}RequiredVersion"
         )
@@ -539,24 +1533,106 @@ function (_DAPPER_BUILD_JSON -outJson -allNames -allDaps)
     endforeach ()
     _DAPPER_ARRAY_TO_JSON(-jsonDependencies ${-dependencies})
 
+    get_property (-explored GLOBAL PROPERTY "${-dapPrefix}Explored")
+    if (-declarations AND NOT -explored)
+      list (APPEND -jsonMembers [["unexplored":true]])
+    endif ()
+
     string (JOIN "," -jsonMembers ${-jsonMembers})
     string (CONFIGURE "{${-jsonMembers}}" -jsonDap @ONLY)
     list (APPEND -knownDapPairs "${-dapId}" "${-jsonDap}")
   endforeach ()
   _DAPPER_KV_PAIRS_TO_JSON(-jsonKnownDaps ${-knownDapPairs})
 
+  if (-numRoots EQUAL 1)
+    string (
+      CONFIGURE
+        [[{"entry":"@-roots@","names":@-jsonNames@,"daps":@-jsonKnownDaps@}]]
+        -json @ONLY
+    )
+    set ("${-outJson}" "${-json}" PARENT_SCOPE)
+    return ()
+  endif ()
+
+  set (-rootPairs)
+  foreach (-root IN LISTS -roots)
+    set (-lockPairs)
+    foreach (-name IN LISTS -allNames)
+      _DAPPER_ROOT_NAME_PREFIX(-rootNamePrefix "${-root}" "${-name}")
+      get_property (
+        -lockedDapId GLOBAL PROPERTY "${-rootNamePrefix}LockedPackage"
+      )
+      if (-lockedDapId)
+        string (CONFIGURE [["@-lockedDapId@"]] -jsonDapId @ONLY ESCAPE_QUOTES)
+        list (APPEND -lockPairs "${-name}" "${-jsonDapId}")
+      endif ()
+    endforeach ()
+    _DAPPER_KV_PAIRS_TO_JSON(-jsonLocks ${-lockPairs})
+    list (APPEND -rootPairs "${-root}" "{\"locked\":${-jsonLocks}}")
+  endforeach ()
+  _DAPPER_KV_PAIRS_TO_JSON(-jsonRoots ${-rootPairs})
+
   string (
     CONFIGURE
-      [[{"entry":"ROOT","names":@-jsonNames@,"daps":@-jsonKnownDaps@}]]
+      [[{"roots":@-jsonRoots@,"names":@-jsonNames@,"daps":@-jsonKnownDaps@}]]
       -json @ONLY
   )
   set ("${-outJson}" "${-json}" PARENT_SCOPE)
 endfunction ()
 
-function (_DAPPER_ALL_RELEVANT_NAMES -outNames)
+# Picks the DAPs of the name which dappi would plausibly select once the
+# name is known: the ones locked by the roots and the newest ones.
+function (_DAPPER_SPECULATE -outDaps -name)
+  _DAPPER_NAME_PREFIX(-namePrefix "${-name}")
+  get_property (-knownDapIds GLOBAL PROPERTY "${-namePrefix}KnownPackages")
+
+  set (-entries)
+  foreach (-dapId IN LISTS -knownDapIds)
+    _DAPPER_DAP_PREFIX(-dapPrefix "${-dapId}")
+    get_property (-version GLOBAL PROPERTY "${-dapPrefix}Version")
+    list (APPEND -entries "${-version}/${-dapId}")
+  endforeach ()
+  list (SORT -entries COMPARE NATURAL ORDER DESCENDING)
+
+  set (-daps)
+  set (-len 0)
+  get_property (-roots GLOBAL PROPERTY "Dapper::Roots")
+  foreach (-root IN LISTS -roots)
+    _DAPPER_ROOT_NAME_PREFIX(-rootNamePrefix "${-root}" "${-name}")
+    get_property (
+      -lockedDapId GLOBAL PROPERTY "${-rootNamePrefix}LockedPackage"
+    )
+    get_property (
+      -lockedKnown GLOBAL PROPERTY
+      "${-namePrefix}KnownPackage::${-lockedDapId}" SET
+    )
+    if (
+      -lockedDapId AND -lockedKnown
+      AND NOT DEFINED "-isPicked::${-lockedDapId}"
+    )
+      set ("-isPicked::${-lockedDapId}" true)
+      list (APPEND -daps "${-lockedDapId}")
+      math (EXPR -len "${-len} + 1")
+    endif ()
+  endforeach ()
+  foreach (-entry IN LISTS -entries)
+    if (-len GREATER_EQUAL DAPPER_FRONTIER_SIZE)
+      break ()
+    endif ()
+    string (REGEX REPLACE "^.*/" "" -dapId "${-entry}")
+    if (NOT DEFINED "-isPicked::${-dapId}")
+      set ("-isPicked::${-dapId}" true)
+      list (APPEND -daps "${-dapId}")
+      math (EXPR -len "${-len} + 1")
+    endif ()
+  endforeach ()
+  set ("${-outDaps}" "${-daps}" PARENT_SCOPE)
+endfunction ()
+
+function (_DAPPER_ALL_RELEVANT_NAMES -outNames -root)
   set (-names)
-  set (-daps ROOT)
-  set (-queue "${-daps}")
+  set (-queue "${-root}")
+  set ("-isQueued::${-root}" true)
   while (-queue)
     list (POP_FRONT -queue -dapId)
 
@@ -566,15 +1642,16 @@ function (_DAPPER_ALL_RELEVANT_NAMES -outNames)
     foreach (-decl IN LISTS -declarations)
       _DAPPER_DECLARATION_PREFIX(-declPrefix "${-decl}")
       get_property (-name GLOBAL PROPERTY "${-declPrefix}Name")
-      if (NOT -name IN_LIST -names)
+      if (NOT DEFINED "-isListed::${-name}")
+        set ("-isListed::${-name}" true)
         list (APPEND -names "${-name}")
       endif ()
-      _DAPPER_NAME_PREFIX(-namePrefix "${-name}")
+      _DAPPER_ROOT_NAME_PREFIX(-rootNamePrefix "${-root}" "${-name}")
       get_property (
-        -selectedDap GLOBAL PROPERTY "${-namePrefix}SelectedPackage"
+        -selectedDap GLOBAL PROPERTY "${-rootNamePrefix}SelectedPackage"
       )
-      if (NOT -selectedDap IN_LIST -daps)
-        list (APPEND -daps "${-selectedDap}")
+      if (NOT DEFINED "-isQueued::${-selectedDap}")
+        set ("-isQueued::${-selectedDap}" true)
         list (APPEND -queue "${-selectedDap}")
       endif ()
     endforeach ()
@@ -599,6 +1676,10 @@ else ()
   DAPPER_DEFINE_PRESET_HOSTS()
 endif ()
 
+_DAPPER_PROFILE_BEGIN(-resolveBegin)
+_DAPPER_NOW(-now)
+set_property (GLOBAL PROPERTY "Dapper::ResolveBegin" "${-now}")
+
 set (-dappiBinDir "${DAPPER_BINARY_DIR}/dappi")
 find_program (
   DAPPI_EXECUTABLE
@@ -607,6 +1688,7 @@ find_program (
 
 # TODO : Perform auto-upgrading
 if (NOT DAPPI_EXECUTABLE)
+  _DAPPER_PROFILE_BEGIN(-phaseBegin)
   message (STATUS "Configuring dappi...")
   execute_process (
     COMMAND
@@ -649,33 +1731,141 @@ if (NOT DAPPI_EXECUTABLE)
     DAPPI_EXECUTABLE
     dappi PATHS "${-dappiBinDir}/install/bin" REQUIRED NO_DEFAULT_PATHS
   )
+  _DAPPER_PROFILE_END("${-phaseBegin}" phase "Build dappi")
+endif ()
+
+# dappi hands its commands to the server listening on DAPPI_SOCKET, or runs
+# them by itself when no server listens there.
+if (NOT DAPPER_SERVER STREQUAL "")
+  set (ENV{DAPPI_SOCKET} "${DAPPER_SERVER}")
 endif ()
 
 message (STATUS "Resolving dependencies...")
 
-_DAPPER_NEW_DAP(ROOT)
-_DAPPER_DAP_PREFIX(-prefix ROOT)
-set_property (GLOBAL PROPERTY "${-prefix}Name" "${DAPPER_PROJECT_NAME}")
-set_property (GLOBAL PROPERTY "${-prefix}Version" "${DAPPER_PROJECT_VERSION}")
-set_property (GLOBAL PROPERTY "${-prefix}SourceDir" "${DAPPER_SOURCE_DIR}")
+# DAPPER_TIME_LIMIT counts from here, fetches included, so each iteration of
+# dappi is given what is left of it.
+if (NOT DAPPER_TIME_LIMIT STREQUAL "")
+  _DAPPER_NOW(-timeLimitBegin)
+  _DAPPER_SECONDS_TO_MICROS(-timeLimit "${DAPPER_TIME_LIMIT}")
+endif ()
+
+# A workspace lists projects as "<source dir>=<binary dir>", which become the
+# roots ROOT_0, ROOT_1 and so on. They are resolved together, each into its
+# own lockfile and ResolvedDependencies.cmake.
+set (-roots)
+if (DEFINED DAPPER_WORKSPACE)
+  foreach (-project IN LISTS DAPPER_WORKSPACE)
+    string (FIND "${-project}" "=" -pos)
+    if (-pos LESS 1)
+      message (FATAL_ERROR "Invalid workspace project - ${-project}")
+    endif ()
+    string (SUBSTRING "${-project}" 0 ${-pos} -sourceDir)
+    math (EXPR -pos "${-pos} + 1")
+    string (SUBSTRING "${-project}" ${-pos} -1 -binaryDir)
+    get_filename_component (-sourceDir "${-sourceDir}" ABSOLUTE)
+    get_filename_component (-binaryDir "${-binaryDir}" ABSOLUTE)
+    get_filename_component (-name "${-sourceDir}" NAME)
+
+    list (LENGTH -roots -n)
+    set (-root "ROOT_${-n}")
+    list (APPEND -roots "${-root}")
+    _DAPPER_DAP_PREFIX(-prefix "${-root}")
+    # DAP_INFO of the project overrides these.
+    set_property (GLOBAL PROPERTY "${-prefix}Name" "${-name}")
+    set_property (GLOBAL PROPERTY "${-prefix}Version" "0.0.0")
+    set_property (GLOBAL PROPERTY "${-prefix}SourceDir" "${-sourceDir}")
+    set_property (GLOBAL PROPERTY "${-prefix}BinaryDir" "${-binaryDir}")
+  endforeach ()
+  if (NOT -roots)
+    message (FATAL_ERROR "DAPPER_WORKSPACE has no projects.")
+  endif ()
+else ()
+  set (-roots ROOT)
+  _DAPPER_DAP_PREFIX(-prefix ROOT)
+  set_property (GLOBAL PROPERTY "${-prefix}Name" "${DAPPER_PROJECT_NAME}")
+  set_property (
+    GLOBAL PROPERTY "${-prefix}Version" "${DAPPER_PROJECT_VERSION}"
+  )
+  set_property (GLOBAL PROPERTY "${-prefix}SourceDir" "${DAPPER_SOURCE_DIR}")
+  set_property (GLOBAL PROPERTY "${-prefix}BinaryDir" "${DAPPER_BINARY_DIR}")
+endif ()
+set_property (GLOBAL PROPERTY "Dapper::Roots" "${-roots}")
+
+foreach (-root IN LISTS -roots)
+  _DAPPER_NEW_DAP("${-root}")
+  _DAPPER_DAP_PREFIX(-prefix "${-root}")
+  get_property (-sourceDir GLOBAL PROPERTY "${-prefix}SourceDir")
+  _DAPPER_LOAD_DA("${-root}" "${-sourceDir}")
+endforeach ()
 
-_DAPPER_LOAD_DA(ROOT "${DAPPER_SOURCE_DIR}")
+set (-dappiRunArgs)
+if (DAPPER_SOLVER_JOBS GREATER 1)
+  list (APPEND -dappiRunArgs --jobs "${DAPPER_SOLVER_JOBS}")
+endif ()
+if (NOT DAPPER_CONFLICT_BUDGET STREQUAL "")
+  list (APPEND -dappiRunArgs --conflict-budget "${DAPPER_CONFLICT_BUDGET}")
+endif ()
+if (DAPPER_FRONTIER_SIZE GREATER 0)
+  list (APPEND -dappiRunArgs --frontier "${DAPPER_FRONTIER_SIZE}")
+endif ()
+if (NOT DAPPER_OPTIMIZATION STREQUAL "total")
+  list (APPEND -dappiRunArgs --optimization "${DAPPER_OPTIMIZATION}")
+endif ()
+if (NOT DAPPER_ENGINE STREQUAL "sat")
+  list (APPEND -dappiRunArgs --engine "${DAPPER_ENGINE}")
+endif ()
+if (DAPPER_SIMPLIFY)
+  list (APPEND -dappiRunArgs --simplify)
+endif ()
+if (DAPPER_UPDATE)
+  list (APPEND -dappiRunArgs --update ${DAPPER_UPDATE})
+endif ()
 
 set (dappiFinished false)
 set (-inputJsonFile "${DAPPER_BINARY_DIR}/dappi.json")
 set (-iteration 0)
-set (-allDaps ROOT)
+set (-allDaps ${-roots})
 set (-allNames)
+set (dappiFrontier)
 while (-iteration LESS 100)
-  set (-processedDaps)
-  set (-unprocessedDaps ROOT)
+  _DAPPER_PROFILE_BEGIN(-iterationBegin)
+  _DAPPER_PROFILE_BEGIN(-phaseBegin)
+  # DAPs which may be selected next are walked ahead, so that the selection
+  # does not need another iteration to learn their dependencies. Each DAP is
+  # queued once in an iteration, which is recorded in its WalkedIn.
+  set (-unprocessedDaps)
+  foreach (-dapId IN ITEMS ${-roots} ${dappiFrontier})
+    _DAPPER_DAP_PREFIX(-prefix "${-dapId}")
+    get_property (-walkedIn GLOBAL PROPERTY "${-prefix}WalkedIn")
+    if (NOT -walkedIn STREQUAL -iteration)
+      set_property (GLOBAL PROPERTY "${-prefix}WalkedIn" "${-iteration}")
+      list (APPEND -unprocessedDaps "${-dapId}")
+    endif ()
+  endforeach ()
+  foreach (-dapId IN LISTS dappiFrontier)
+    _DAPPER_DAP_PREFIX(-prefix "${-dapId}")
+    set_property (GLOBAL PROPERTY "${-prefix}SpeculatedIn" "${-iteration}")
+  endforeach ()
 
+  # DAPs are walked in waves of those queued by the previous wave, and the
+  # revisions which each wave declares are peeked ahead of it in one batch.
+  set (-waveLeft 0)
   while (-unprocessedDaps)
+    if (-waveLeft EQUAL 0)
+      list (LENGTH -unprocessedDaps -waveLeft)
+      _DAPPER_PEEK_AHEAD(${-unprocessedDaps})
+    endif ()
+    math (EXPR -waveLeft "${-waveLeft} - 1")
     list (POP_FRONT -unprocessedDaps -dapId)
-    list (APPEND -processedDaps "${-dapId}")
+    _DAPPER_DAP_PREFIX(-prefix "${-dapId}")
+    get_property (-speculatedIn GLOBAL PROPERTY "${-prefix}SpeculatedIn")
+    set (-speculative false)
+    if (-speculatedIn STREQUAL -iteration)
+      set (-speculative true)
+    endif ()
+    set (-explored true)
 
     set (-dependencies)
-    _DAPPER_DAP_PREFIX(-prefix "${-dapId}")
     get_property (-declarations GLOBAL PROPERTY "${-prefix}Declarations")
 
     foreach (-decl IN LISTS -declarations)
@@ -688,26 +1878,21 @@ while (-iteration LESS 100)
         -knownLocations GLOBAL PROPERTY "${-declPrefix}KnownLocations"
       )
 
-      if (NOT -nameFromDecl IN_LIST -allNames)
+      _DAPPER_NAME_PREFIX(-namePrefix "${-nameFromDecl}")
+      get_property (-known GLOBAL PROPERTY "${-namePrefix}KnownPackages" SET)
+      if (NOT -known)
         _DAPPER_NEW_NAME("${-nameFromDecl}")
         list (APPEND -allNames "${-nameFromDecl}")
       endif ()
 
       set (-names "${-nameFromDecl}")
       foreach (-location IN LISTS -knownLocations)
-        string (REGEX REPLACE "#(.*)$" ";\\1" -parsedLocation "${-location}")
-        list (GET -parsedLocation 0 -url)
-        list (LENGTH -parsedLocation -len)
-        if (-len LESS_EQUAL 1)
-          set (-fetchArgs)
-        else ()
-          list (GET -parsedLocation 1 -fragment)
-          set (-fetchArgs GIT_TAG "${-fragment}")
-        endif ()
+        _DAPPER_PARSE_LOCATION(-url -fetchArgs "${-location}")
 
         _DAPPER_FETCH(
           -hashes
           NAME "${-nameFromDecl}"
+          REQUIRE "${-requiredVersion}"
           GIT_REPOSITORY "${-url}"
           ${-fetchArgs}
         )
@@ -721,7 +1906,11 @@ while (-iteration LESS 100)
               list (APPEND -names "${-name}")
             endif ()
 
-            if (NOT -name IN_LIST -allNames)
+            _DAPPER_NAME_PREFIX(-namePrefix "${-name}")
+            get_property (
+              -known GLOBAL PROPERTY "${-namePrefix}KnownPackages" SET
+            )
+            if (NOT -known)
               _DAPPER_NEW_NAME("${-name}")
               list (APPEND -allNames "${-name}")
             endif ()
@@ -731,18 +1920,19 @@ while (-iteration LESS 100)
 
           if (-name)
             _DAPPER_NAME_PREFIX(-namePrefix "${-name}")
-            get_property (
-              -knownPackages
-              GLOBAL PROPERTY "${-namePrefix}KnownPackages"
-            )
-            if (NOT -hash IN_LIST -knownPackages)
+            set (-knownPackage "${-namePrefix}KnownPackage::${-hash}")
+            get_property (-known GLOBAL PROPERTY "${-knownPackage}" SET)
+            if (NOT -known)
+              set_property (GLOBAL PROPERTY "${-knownPackage}" true)
               set_property (
                 GLOBAL APPEND PROPERTY "${-namePrefix}KnownPackages" "${-hash}"
               )
             endif ()
           endif ()
 
-          if (NOT -hash IN_LIST -allDaps)
+          get_property (-discovered GLOBAL PROPERTY "${-dapPrefix}Discovered")
+          if (NOT -discovered)
+            set_property (GLOBAL PROPERTY "${-dapPrefix}Discovered" true)
             list (APPEND -allDaps "${-hash}")
           endif ()
         endforeach ()
@@ -752,7 +1942,11 @@ while (-iteration LESS 100)
       list (LENGTH -names -namesLen)
       get_property (-from GLOBAL PROPERTY "${-declPrefix}From")
       get_property (-locations GLOBAL PROPERTY "${-declPrefix}Locations")
-      if (-namesLen EQUAL 0)
+      if (-speculative AND NOT -namesLen EQUAL 1)
+        # It will be reported if the DAP is actually selected.
+        set (-explored false)
+        continue ()
+      elseif (-namesLen EQUAL 0)
         message (
           FATAL_ERROR "DAP name not provided by ${-locations} at ${-from}"
         )
@@ -768,30 +1962,84 @@ while (-iteration LESS 100)
         set_property (GLOBAL PROPERTY "${-declPrefix}Name" "${-names}")
       endif ()
 
-      _DAPPER_NAME_PREFIX(-namePrefix "${-names}")
-      get_property (
-        -selectedDapId GLOBAL PROPERTY "${-namePrefix}SelectedPackage"
-      )
-      if (-selectedDapId AND NOT -selectedDapId IN_LIST -processedDaps)
-        list (APPEND -unprocessedDaps "${-selectedDapId}")
-        list (REMOVE_DUPLICATES -unprocessedDaps)
+      # The selections of every root are walked.
+      set (-nextDaps)
+      foreach (-root IN LISTS -roots)
+        _DAPPER_ROOT_NAME_PREFIX(-rootNamePrefix "${-root}" "${-names}")
+        get_property (
+          -selectedDapId GLOBAL PROPERTY "${-rootNamePrefix}SelectedPackage"
+        )
+        if (-selectedDapId AND NOT -selectedDapId IN_LIST -nextDaps)
+          list (APPEND -nextDaps "${-selectedDapId}")
+        endif ()
+      endforeach ()
+      if (NOT -nextDaps AND DAPPER_FRONTIER_SIZE GREATER 0)
+        _DAPPER_SPECULATE(-nextDaps "${-names}")
+        foreach (-nextDap IN LISTS -nextDaps)
+          _DAPPER_DAP_PREFIX(-nextPrefix "${-nextDap}")
+          set_property (
+            GLOBAL PROPERTY "${-nextPrefix}SpeculatedIn" "${-iteration}"
+          )
+        endforeach ()
       endif ()
+      foreach (-nextDap IN LISTS -nextDaps)
+        _DAPPER_DAP_PREFIX(-nextPrefix "${-nextDap}")
+        get_property (-walkedIn GLOBAL PROPERTY "${-nextPrefix}WalkedIn")
+        if (NOT -walkedIn STREQUAL -iteration)
+          set_property (
+            GLOBAL PROPERTY "${-nextPrefix}WalkedIn" "${-iteration}"
+          )
+          list (APPEND -unprocessedDaps "${-nextDap}")
+        endif ()
+      endforeach ()
     endforeach ()
+
+    if (-explored)
+      set_property (GLOBAL PROPERTY "${-prefix}Explored" true)
+    endif ()
   endwhile ()
+  _DAPPER_PROFILE_END("${-phaseBegin}" phase "Discovery")
 
   set (dappiFinished true)
-  _DAPPER_BUILD_JSON(-json "${-allNames}" "${-allDaps}")
+  set (dappiNonOptimal false)
+  set (dappiFrontier)
+  _DAPPER_PROFILE_BEGIN(-phaseBegin)
+  _DAPPER_BUILD_JSON(-json "${-roots}" "${-allNames}" "${-allDaps}")
   file (WRITE "${-inputJsonFile}" "${-json}")
+  _DAPPER_PROFILE_END("${-phaseBegin}" phase "Build JSON")
+  set (-dappiStatsArgs)
+  if (DAPPER_SOLVER_STATS)
+    list (
+      APPEND -dappiStatsArgs
+      --stats "${DAPPER_BINARY_DIR}/dappi-stats-${-iteration}.json"
+    )
+  endif ()
+  set (-dappiTimeArgs)
+  if (NOT DAPPER_TIME_LIMIT STREQUAL "")
+    _DAPPER_NOW(-now)
+    math (EXPR -timeLeft "${-timeLimit} - (${-now} - ${-timeLimitBegin})")
+    if (-timeLeft LESS 0)
+      set (-timeLeft 0)
+    endif ()
+    _DAPPER_MICROS_TO_SECONDS(-timeLeft "${-timeLeft}")
+    list (APPEND -dappiTimeArgs --time-limit "${-timeLeft}")
+  endif ()
+  _DAPPER_PROFILE_BEGIN(-phaseBegin)
   execute_process (
-    COMMAND "${DAPPI_EXECUTABLE}" run
+    COMMAND
+      "${DAPPI_EXECUTABLE}" run
+      ${-dappiRunArgs} ${-dappiTimeArgs} ${-dappiStatsArgs}
     RESULT_VARIABLE -code
     OUTPUT_VARIABLE -dappiInsts
     INPUT_FILE "${-inputJsonFile}"
   )
+  _DAPPER_PROFILE_END("${-phaseBegin}" dappi "dappi run")
   if (NOT -code EQUAL 0)
     message (FATAL_ERROR "dappi run failed.")
   endif ()
+  list (GET -roots 0 dappiRoot)
   cmake_language (EVAL CODE "${-dappiInsts}")
+  _DAPPER_PROFILE_END("${-iterationBegin}" phase "Iteration ${-iteration}")
 
   if (dappiFinished)
     break ()
@@ -803,89 +2051,152 @@ if (NOT dappiFinished)
   message (FATAL_ERROR "Number of iterations reached maximum count.")
 endif ()
 
-message (STATUS "Resolving dependencies: done.")
+if (dappiNonOptimal AND DAPPER_ENGINE STREQUAL "pubgrub")
+  message (
+    STATUS
+    "The selected packages are valid but not minimized, as DAPPER_ENGINE is "
+    "pubgrub."
+  )
+elseif (dappiNonOptimal)
+  message (
+    WARNING
+    "dappi ran out of DAPPER_TIME_LIMIT or DAPPER_CONFLICT_BUDGET. "
+    "The selected packages are valid but may not be optimal."
+  )
+endif ()
 
-_DAPPER_ALL_RELEVANT_NAMES(-allNames)
-list (SORT -allNames)
+message (STATUS "Resolving dependencies: done.")
 
 message (STATUS "Checking integrities...")
-
-foreach (-name IN LISTS -allNames)
-  _DAPPER_NAME_PREFIX(-namePrefix "${-name}")
-  get_property (-dapId GLOBAL PROPERTY "${-namePrefix}SelectedPackage")
-  get_property (-lock GLOBAL PROPERTY "${-namePrefix}LockedPackage")
-  if (-lock STREQUAL -dapId)
-    _DAPPER_LOCK_PREFIX(-lockPrefix "${-name}")
-    get_property (-algorithm GLOBAL PROPERTY "${-lockPrefix}IntegrityAlgorithm")
-    if (NOT -algorithm STREQUAL "sha512")
+_DAPPER_PROFILE_BEGIN(-phaseBegin)
+
+foreach (-root IN LISTS -roots)
+  _DAPPER_ALL_RELEVANT_NAMES(-names "${-root}")
+  list (SORT -names)
+  set_property (GLOBAL PROPERTY "Dapper::Roots::${-root}::Names" "${-names}")
+
+  foreach (-name IN LISTS -names)
+    _DAPPER_ROOT_NAME_PREFIX(-rootNamePrefix "${-root}" "${-name}")
+    get_property (-dapId GLOBAL PROPERTY "${-rootNamePrefix}SelectedPackage")
+    get_property (-lock GLOBAL PROPERTY "${-rootNamePrefix}LockedPackage")
+    if (-lock STREQUAL -dapId)
+      _DAPPER_LOCK_PREFIX(-lockPrefix "${-root}" "${-name}")
+      get_property (
+        -algorithm GLOBAL PROPERTY "${-lockPrefix}IntegrityAlgorithm"
+      )
+      if (NOT -algorithm STREQUAL "sha512")
+        message (
+          FATAL_ERROR
+          "Integrity check failed: unsupported algorithm - ${-algorithm}"
+        )
+      endif ()
+      get_property (-originalDigest GLOBAL PROPERTY "${-lockPrefix}Digest")
+    else ()
+      set (-originalDigest)
+    endif ()
+    _DAPPER_DAP_PREFIX(-dapPrefix "${-dapId}")
+    get_property (-url GLOBAL PROPERTY "${-dapPrefix}URL")
+    get_property (-revision GLOBAL PROPERTY "${-dapPrefix}Fragment")
+    # Roots of a workspace selecting the same DAP share its digest.
+    get_property (-digest GLOBAL PROPERTY "${-dapPrefix}Digest")
+    if (NOT -digest)
+      get_property (-sourceDir GLOBAL PROPERTY "${-dapPrefix}SourceDir")
+      _DAPPER_INDEXED_INTEGRITY(-digest "${-dapId}")
+      if (NOT -digest)
+        _DAPPER_CALC_INTEGRITY(-digest "${-sourceDir}" "${-revision}")
+      endif ()
+    endif ()
+    if (-originalDigest AND NOT -digest STREQUAL -originalDigest)
       message (
         FATAL_ERROR
-        "Integrity check failed: unsupported algorithm - ${-algorithm}"
+        "Integrity check failed: "
+        "digests mismatch at ${-name} from ${-url}#${-revision} - "
+        "${-digest} vs ${-originalDigest}"
       )
     endif ()
-    get_property (-originalDigest GLOBAL PROPERTY "${-lockPrefix}Digest")
-  else ()
-    set (-originalDigest)
-  endif ()
-  _DAPPER_DAP_PREFIX(-dapPrefix "${-dapId}")
-  get_property (-sourceDir GLOBAL PROPERTY "${-dapPrefix}SourceDir")
-  get_property (-url GLOBAL PROPERTY "${-dapPrefix}URL")
-  get_property (-revision GLOBAL PROPERTY "${-dapPrefix}Fragment")
-  _DAPPER_CALC_INTEGRITY(-digest "${-sourceDir}" "${-revision}")
-  if (-originalDigest AND NOT -digest STREQUAL -originalDigest)
-    message (
-      FATAL_ERROR
-      "Integrity check failed: "
-      "digests mismatch at ${-name} from ${-url}#${-revision} - "
-      "${-digest} vs ${-originalDigest}"
-    )
-  endif ()
-  set_property (GLOBAL PROPERTY "${-dapPrefix}IntegrityAlgorithm" sha512)
-  set_property (GLOBAL PROPERTY "${-dapPrefix}Digest" "${-digest}")
+    set_property (GLOBAL PROPERTY "${-dapPrefix}IntegrityAlgorithm" sha512)
+    set_property (GLOBAL PROPERTY "${-dapPrefix}Digest" "${-digest}")
+  endforeach ()
 endforeach ()
 
+_DAPPER_PROFILE_END("${-phaseBegin}" phase "Integrity check")
 message (STATUS "Checking integrities: done.")
 
-_DAPPER_BUILD_JSON(-json "${-allNames}" "${-allDaps}")
-file (WRITE "${-inputJsonFile}" "${-json}")
-execute_process (
-  COMMAND
-    "${DAPPI_EXECUTABLE}"
-    save -o "${DAPPER_SOURCE_DIR}/DependencyAwarenessLock.yml"
-  RESULT_VARIABLE -code
-  INPUT_FILE "${-inputJsonFile}"
-)
-if (NOT -code EQUAL 0)
-  message (FATAL_ERROR "dappi save failed.")
-endif ()
+foreach (-name IN LISTS DAPPER_UPDATE)
+  set (-relevant false)
+  foreach (-root IN LISTS -roots)
+    get_property (-names GLOBAL PROPERTY "Dapper::Roots::${-root}::Names")
+    if (-name IN_LIST -names)
+      set (-relevant true)
+      break ()
+    endif ()
+  endforeach ()
+  if (NOT -relevant)
+    message (WARNING "${-name} in DAPPER_UPDATE is not a dependency.")
+  endif ()
+endforeach ()
 
-set (-useFileLines)
-foreach (-name IN LISTS -allNames)
-  _DAPPER_NAME_PREFIX(-namePrefix "${-name}")
-  get_property (-dapId GLOBAL PROPERTY "${-namePrefix}SelectedPackage")
-  _DAPPER_DAP_PREFIX(-dapPrefix "${-dapId}")
-  get_property (-version GLOBAL PROPERTY "${-dapPrefix}Version")
-  get_property (-sourceDir GLOBAL PROPERTY "${-dapPrefix}SourceDir")
-  get_property (-url GLOBAL PROPERTY "${-dapPrefix}URL")
-  get_property (-revision GLOBAL PROPERTY "${-dapPrefix}Fragment")
-  list (
-    APPEND
-    -useFileLines
-    "DAPPER_USE(\n"
-    "  NAME \"${-name}\"\n"
-    "  VERSION \"${-version}\"\n"
-    "  SOURCE_DIR \"${-sourceDir}\"\n"
-    "  REVISION \"${-revision}\"\n"
-    ")\n"
+foreach (-root IN LISTS -roots)
+  _DAPPER_DAP_PREFIX(-rootPrefix "${-root}")
+  get_property (-rootSourceDir GLOBAL PROPERTY "${-rootPrefix}SourceDir")
+  get_property (-rootBinaryDir GLOBAL PROPERTY "${-rootPrefix}BinaryDir")
+  get_property (-names GLOBAL PROPERTY "Dapper::Roots::${-root}::Names")
+
+  _DAPPER_PROFILE_BEGIN(-phaseBegin)
+  _DAPPER_BUILD_JSON(-json "${-root}" "${-names}" "${-allDaps}")
+  file (WRITE "${-inputJsonFile}" "${-json}")
+  execute_process (
+    COMMAND
+      "${DAPPI_EXECUTABLE}"
+      save -o "${-rootSourceDir}/DependencyAwarenessLock.yml"
+    RESULT_VARIABLE -code
+    INPUT_FILE "${-inputJsonFile}"
   )
-endforeach ()
+  if (NOT -code EQUAL 0)
+    message (FATAL_ERROR "dappi save failed.")
+  endif ()
+  _DAPPER_PROFILE_END("${-phaseBegin}" phase "Save lockfile")
 
-string (JOIN "" -fileBody ${-useFileLines})
-set (-resultFile "${DAPPER_BINARY_DIR}/ResolvedDependencies.cmake")
-if (EXISTS "${-resultFile}")
-  file (READ "${-resultFile}" -fileBodyOld)
-  if (-fileBody STREQUAL -fileBodyOld)
-    return ()
+  _DAPPER_PROFILE_BEGIN(-phaseBegin)
+  set (-useFileLines)
+  foreach (-name IN LISTS -names)
+    _DAPPER_ROOT_NAME_PREFIX(-rootNamePrefix "${-root}" "${-name}")
+    get_property (-dapId GLOBAL PROPERTY "${-rootNamePrefix}SelectedPackage")
+    _DAPPER_DAP_PREFIX(-dapPrefix "${-dapId}")
+    get_property (-version GLOBAL PROPERTY "${-dapPrefix}Version")
+    get_property (-sourceDir GLOBAL PROPERTY "${-dapPrefix}SourceDir")
+    get_property (-url GLOBAL PROPERTY "${-dapPrefix}URL")
+    get_property (-revision GLOBAL PROPERTY "${-dapPrefix}Fragment")
+    list (
+      APPEND
+      -useFileLines
+      "DAPPER_USE(\n"
+      "  NAME \"${-name}\"\n"
+      "  VERSION \"${-version}\"\n"
+      "  SOURCE_DIR \"${-sourceDir}\"\n"
+      "  REVISION \"${-revision}\"\n"
+    )
+    if (DAPPER_EXPORT_SOURCES)
+      _DAPPER_EXPORT_SOURCE(-exportDir "${-sourceDir}" "${-revision}")
+      list (APPEND -useFileLines "  EXPORT_DIR \"${-exportDir}\"\n")
+    endif ()
+    list (APPEND -useFileLines ")\n")
+  endforeach ()
+  _DAPPER_PROFILE_END("${-phaseBegin}" phase "Export sources")
+
+  string (JOIN "" -fileBody ${-useFileLines})
+  set (-resultFile "${-rootBinaryDir}/ResolvedDependencies.cmake")
+  set (-changed true)
+  if (EXISTS "${-resultFile}")
+    file (READ "${-resultFile}" -fileBodyOld)
+    if (-fileBody STREQUAL -fileBodyOld)
+      set (-changed false)
+    endif ()
   endif ()
-endif ()
-file (WRITE "${-resultFile}" "${-fileBody}")
+  if (-changed)
+    file (WRITE "${-resultFile}" "${-fileBody}")
+  endif ()
+endforeach ()
+
+_DAPPER_PROFILE_END("${-resolveBegin}" phase "Resolve dependencies")
+_DAPPER_PROFILE_WRITE("${DAPPER_BINARY_DIR}/dapper-profile.json")
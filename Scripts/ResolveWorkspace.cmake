@@ -0,0 +1,68 @@
+# Copyright (c) 2024 Flokart World, Inc.
+#
+# This software is provided 'as-is', without any express or implied
+# warranty. In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+#    1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation would be
+#    appreciated but is not required.
+#
+#    2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+#
+#    3. This notice may not be removed or altered from any source distribution.
+
+
+# Resolves the dependencies of several projects in one pass, writing the
+# lockfile of each project and the ResolvedDependencies.cmake of its binary
+# directory, which the configuration of the project then picks up.
+#
+#   cmake -D "DAPPER_WORKSPACE=<source dir>=<binary dir>;..."
+#         [-D DAPPER_BINARY_DIR=<dir>] [-D DAPPER_REPOSITORIES_DIR=<dir>]
+#         [-D DAPPER_CONFIG_FILE=<file>] [-D DAPPI_EXECUTABLE=<dappi>]
+#         [-D DAPPER_<OPTION>=<value> ...]
+#         -P ResolveWorkspace.cmake
+
+cmake_minimum_required (VERSION 3.18)
+
+if (NOT DAPPER_WORKSPACE)
+  message (FATAL_ERROR "DAPPER_WORKSPACE must be specified.")
+endif ()
+
+get_filename_component (Dapper_DIR "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+include ("${Dapper_DIR}/DapperConfig.cmake")
+
+set (DAPPER_ROOT_DIR "${Dapper_DIR}")
+if (NOT DAPPER_BINARY_DIR)
+  set (DAPPER_BINARY_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+endif ()
+get_filename_component (DAPPER_BINARY_DIR "${DAPPER_BINARY_DIR}" ABSOLUTE)
+file (MAKE_DIRECTORY "${DAPPER_BINARY_DIR}")
+
+# Repositories are shared with the projects under CPM_SOURCE_CACHE, just as
+# the CPM integration does.
+if (NOT DAPPER_REPOSITORIES_DIR)
+  if (DEFINED ENV{CPM_SOURCE_CACHE})
+    set (
+      DAPPER_REPOSITORIES_DIR
+      "$ENV{CPM_SOURCE_CACHE}/cpm/plugins/dapper/repositories"
+    )
+  else ()
+    set (DAPPER_REPOSITORIES_DIR "${DAPPER_BINARY_DIR}/dapper/repositories")
+  endif ()
+endif ()
+get_filename_component (
+  DAPPER_REPOSITORIES_DIR "${DAPPER_REPOSITORIES_DIR}" ABSOLUTE
+)
+
+if (NOT DAPPER_CONFIG_FILE)
+  set (DAPPER_CONFIG_FILE "$ENV{DAPPER_CONFIG_FILE}")
+endif ()
+
+include ("${Dapper_DIR}/Scripts/ResolveDependencies.cmake")
@@ -0,0 +1,600 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "ecosystem_generator.hpp"
+#include "dappi.hpp"
+
+namespace {
+
+struct benchmark_options : dappi::resolve_options {
+    /* Runs both engines on each input to compare them */
+    bool compare = false;
+    std::size_t repeat = 3;
+    bool workspace = true;
+    std::size_t updates = 0;
+};
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start) {
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+/*
+ * Returns why the selections break the problem, or an empty string if each
+ * root selects candidates of the names, which satisfy the requirements of
+ * its entry and of every selected DAP. Names are exclusive by themselves,
+ * as a root selects at most one DAP for each.
+ */
+std::string check_selections(
+    const dappi::resolution_problem &problem,
+    const dappi::selection_set &selections
+) {
+    for (std::size_t root = 0; root < problem.roots.size(); ++root) {
+        auto &this_root = problem.roots[root];
+        auto check_dependencies = [&](std::size_t dap) -> std::string {
+            for (auto &dep : problem.daps[dap].dependencies) {
+                auto &candidates = problem.names[dep.name].candidates;
+                auto selected = selections.selection(root, dep.name);
+                bool satisfied = selected && std::any_of(
+                    dep.satisfying.begin(),
+                    dep.satisfying.end(),
+                    [&](std::size_t pos) {
+                        return candidates[pos] == *selected;
+                    }
+                );
+                if (!satisfied) {
+                    return this_root.id + ": " + problem.daps[dap].id
+                        + " requires " + problem.names[dep.name].key + " "
+                        + dep.required_version;
+                }
+            }
+            return {};
+        };
+
+        if (this_root.entry) {
+            auto error = check_dependencies(*this_root.entry);
+            if (!error.empty()) {
+                return error;
+            }
+        }
+        for (std::size_t index = 0; index < problem.names.size(); ++index) {
+            auto selected = selections.selection(root, index);
+            if (!selected) {
+                continue;
+            }
+            auto &candidates = problem.names[index].candidates;
+            if (
+                std::find(candidates.begin(), candidates.end(), *selected)
+                == candidates.end()
+            ) {
+                return this_root.id + ": " + problem.daps[*selected].id
+                    + " is not a candidate of " + problem.names[index].key;
+            }
+            auto error = check_dependencies(*selected);
+            if (!error.empty()) {
+                return error;
+            }
+        }
+    }
+    return {};
+}
+
+/*
+ * Does what "dappi run" does for the given input, from reading the JSON to
+ * writing the selections. Without the workspace, each root is resolved as a
+ * problem of its own as if its project was configured alone. The output
+ * is left in selections. Returns null if the selections are invalid.
+ */
+nlohmann::json run_once(
+    const std::string &input,
+    const benchmark_options &options,
+    std::string &selections
+) {
+    auto start = clock_type::now();
+    auto state = nlohmann::json::parse(input);
+    auto parse_json_seconds = seconds_since(start);
+
+    auto problem_start = clock_type::now();
+    auto problem = dappi::parse_resolution_problem(state);
+    if (!problem) {
+        return nullptr;
+    }
+    auto num_daps = problem->daps.size();
+    auto num_names = problem->names.size();
+    auto num_roots = problem->roots.size();
+    bool workspace = state.contains("roots");
+
+    /* Updates bump the first direct dependencies of the first root. */
+    if (auto &entry = problem->roots.front().entry; entry) {
+        auto &dependencies = problem->daps[*entry].dependencies;
+        auto num_updates = std::min(options.updates, dependencies.size());
+        for (std::size_t index = 0; index < num_updates; ++index) {
+            problem->names[dependencies[index].name].updating = true;
+        }
+    }
+    std::vector<dappi::resolution_problem> problems;
+    if (options.workspace || num_roots == 1) {
+        problems.push_back(std::move(*problem));
+    } else {
+        for (auto &root : problem->roots) {
+            auto &part = problems.emplace_back();
+            part.daps = problem->daps;
+            part.names = problem->names;
+            part.roots.push_back(root);
+        }
+    }
+    auto parse_problem_seconds = seconds_since(problem_start);
+
+    auto resolve_start = clock_type::now();
+    std::ostringstream output;
+    std::string status = "optimal";
+    std::size_t unlocks = 0;
+    std::vector<std::size_t> penalties;
+    auto statistics = nlohmann::json::array();
+    std::size_t num_dominated = 0;
+    std::size_t num_strata = 1;
+    std::vector<dappi::resolution> resolutions;
+    for (auto &part : problems) {
+        auto &resolution = resolutions.emplace_back(
+            dappi::resolve(part, options)
+        );
+        num_dominated += resolution.dominated;
+        num_strata = std::max(num_strata, resolution.strata);
+
+        auto result = resolution.selections();
+        if (!result) {
+            status = "cancelled";
+            break;
+        } else if (
+            resolution.status == dappi::resolution_status::conflicted
+        ) {
+            status = "conflicted";
+        } else if (
+            resolution.status == dappi::resolution_status::feasible
+        ) {
+            status = "feasible";
+        } else if (resolution.status != dappi::resolution_status::optimal) {
+            status = "nonoptimal";
+        }
+        for (std::size_t root = 0; root < part.roots.size(); ++root) {
+            if (workspace) {
+                output << "DAPPI_ROOT(" << part.roots[root].id << ")\n";
+            }
+            for (std::size_t index = 0; index < part.names.size(); ++index) {
+                auto selected_dap = result->selection(root, index);
+                if (selected_dap) {
+                    output << "DAPPI_SELECT(" << part.names[index].key << " "
+                           << part.daps[*selected_dap].id << ")\n";
+                } else {
+                    output << "DAPPI_UNSELECT(" << part.names[index].key
+                           << ")\n";
+                }
+            }
+        }
+
+        statistics.push_back(resolution.statistics());
+        auto cost = result->cost();
+        unlocks += cost.first;
+        penalties.resize(std::max(penalties.size(), cost.second.size()));
+        for (std::size_t index = 0; index < cost.second.size(); ++index) {
+            penalties[index] += cost.second[index];
+        }
+        if (status == "conflicted") {
+            break;
+        }
+    }
+    auto resolve_seconds = seconds_since(resolve_start);
+    auto total_seconds = seconds_since(start);
+    selections = output.str();
+
+    /* A wrong engine fails the benchmark rather than looking fast. */
+    if (status != "cancelled" && status != "conflicted") {
+        for (std::size_t index = 0; index < problems.size(); ++index) {
+            auto error = check_selections(
+                problems[index],
+                *resolutions[index].selections()
+            );
+            if (!error.empty()) {
+                std::cerr << "ERROR: Invalid selections - " << error
+                          << std::endl;
+                return nullptr;
+            }
+        }
+    }
+
+    nlohmann::json run = {
+        { "status", status },
+        {
+            "seconds",
+            {
+                { "total", total_seconds },
+                { "parseJson", parse_json_seconds },
+                { "parseProblem", parse_problem_seconds },
+                { "resolve", resolve_seconds }
+            }
+        },
+        {
+            "problem",
+            {
+                { "daps", num_daps },
+                { "names", num_names },
+                { "roots", num_roots },
+                { "solvers", problems.size() },
+                { "dominated", num_dominated },
+                { "strata", num_strata }
+            }
+        }
+    };
+    if (status != "cancelled") {
+        /* One per solver, which is one unless the workspace is split */
+        if (statistics.size() == 1) {
+            run["statistics"] = std::move(statistics[0]);
+        } else {
+            run["statistics"] = std::move(statistics);
+        }
+        run["cost"] = {
+            { "unlocks", unlocks },
+            {
+                "penalty",
+                std::accumulate(penalties.begin(), penalties.end(),
+                                std::size_t(0))
+            },
+            { "strata", penalties }
+        };
+    }
+    return run;
+}
+
+/* Runs the input repeatedly on the engine of the options. */
+nlohmann::json run_engine(
+    const std::string &input,
+    const benchmark_options &options,
+    std::string &selections
+) {
+    nlohmann::json result = { { "runs", nlohmann::json::array() } };
+    std::vector<double> totals;
+    for (std::size_t index = 0; index < options.repeat; ++index) {
+        auto run = run_once(input, options, selections);
+        if (run.is_null()) {
+            return nullptr;
+        }
+        totals.push_back(run["seconds"]["total"].get<double>());
+        result["runs"].push_back(std::move(run));
+    }
+
+    std::sort(totals.begin(), totals.end());
+    result["medianSeconds"] = totals[totals.size() / 2];
+    return result;
+}
+
+/*
+ * Returns the status of the run with the ones which have selections made
+ * alike, since pubgrub never proves them optimal.
+ */
+std::string outcome_of(const nlohmann::json &run) {
+    auto status = run["status"].get<std::string>();
+    if (
+        status == "optimal"
+        || status == "feasible"
+        || status == "nonoptimal"
+    ) {
+        return "selected";
+    }
+    return status;
+}
+
+/* Counts the lines which differ between the outputs of the engines. */
+std::size_t count_differences(const std::string &lhs, const std::string &rhs) {
+    std::istringstream lhs_lines(lhs);
+    std::istringstream rhs_lines(rhs);
+    std::string lhs_line;
+    std::string rhs_line;
+    std::size_t result = 0;
+    for (;;) {
+        bool lhs_read = static_cast<bool>(std::getline(lhs_lines, lhs_line));
+        bool rhs_read = static_cast<bool>(std::getline(rhs_lines, rhs_line));
+        if (!lhs_read && !rhs_read) {
+            return result;
+        } else if (lhs_read != rhs_read || lhs_line != rhs_line) {
+            ++result;
+        }
+    }
+}
+
+nlohmann::json run_benchmark(
+    const ecosystem_parameters &parameters,
+    const benchmark_options &options
+) {
+    auto generate_start = clock_type::now();
+    auto input = generate_ecosystem(parameters).dump();
+    auto generate_seconds = seconds_since(generate_start);
+
+    nlohmann::json benchmark = {
+        { "parameters", parameters.to_json() },
+        { "generateSeconds", generate_seconds }
+    };
+
+    std::ostringstream info;
+    info << "INFO: " << to_string(parameters.shape) << " "
+         << parameters.packages << "x" << parameters.versions;
+
+    if (!options.compare) {
+        std::string selections;
+        auto engine = run_engine(input, options, selections);
+        if (engine.is_null()) {
+            return nullptr;
+        }
+        auto &last = engine["runs"].back();
+        std::cerr << info.str() << " (" << last["problem"]["daps"]
+                  << " DAPs): median "
+                  << engine["medianSeconds"].get<double>() << "s, "
+                  << last["status"].get<std::string>() << std::endl;
+        benchmark.update(engine);
+        return benchmark;
+    }
+
+    /* Both engines are given the same input. */
+    auto sat_options = options;
+    sat_options.engine = dappi::resolution_engine::sat;
+    auto pubgrub_options = options;
+    pubgrub_options.engine = dappi::resolution_engine::pubgrub;
+    std::string sat_selections;
+    std::string pubgrub_selections;
+    auto sat = run_engine(input, sat_options, sat_selections);
+    auto pubgrub = run_engine(input, pubgrub_options, pubgrub_selections);
+    if (sat.is_null() || pubgrub.is_null()) {
+        return nullptr;
+    }
+
+    auto &sat_last = sat["runs"].back();
+    auto &pubgrub_last = pubgrub["runs"].back();
+    bool same_outcome = (outcome_of(sat_last) == outcome_of(pubgrub_last));
+    auto differences = count_differences(sat_selections, pubgrub_selections);
+    auto speedup = sat["medianSeconds"].get<double>()
+        / pubgrub["medianSeconds"].get<double>();
+    std::cerr << info.str() << " (" << sat_last["problem"]["daps"]
+              << " DAPs): sat median "
+              << sat["medianSeconds"].get<double>() << "s, "
+              << sat_last["status"].get<std::string>()
+              << "; pubgrub median "
+              << pubgrub["medianSeconds"].get<double>() << "s, "
+              << pubgrub_last["status"].get<std::string>() << "; "
+              << differences << " selections differ" << std::endl;
+
+    benchmark["engines"] = {
+        { "sat", std::move(sat) },
+        { "pubgrub", std::move(pubgrub) }
+    };
+    benchmark["comparison"] = {
+        { "sameOutcome", same_outcome },
+        { "differentSelections", differences },
+        { "speedup", speedup }
+    };
+    return benchmark;
+}
+
+/* Scenarios run when no generator option is given */
+std::vector<ecosystem_parameters> default_suite() {
+    std::vector<ecosystem_parameters> suite;
+    auto add = [&](ecosystem_shape shape, std::size_t packages,
+                   std::size_t versions) {
+        ecosystem_parameters parameters;
+        parameters.shape = shape;
+        parameters.packages = packages;
+        parameters.versions = versions;
+        suite.push_back(parameters);
+    };
+    add(ecosystem_shape::random, 1000, 10);
+    add(ecosystem_shape::chain, 2000, 5);
+    add(ecosystem_shape::diamond, 2000, 5);
+    add(ecosystem_shape::unsatisfiable, 1000, 10);
+    add(ecosystem_shape::random, 10000, 10);
+    return suite;
+}
+
+template <class T>
+bool parse_number(std::string_view str, T &value) {
+    auto [end, error] = std::from_chars(
+        str.data(),
+        str.data() + str.size(),
+        value
+    );
+    return (error == std::errc() && end == str.data() + str.size());
+}
+
+bool parse_fraction(const std::string &str, double &value) {
+    char *end = nullptr;
+    value = std::strtod(str.c_str(), &end);
+    return !str.empty() && *end == '\0' && value >= 0 && value <= 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    ecosystem_parameters parameters;
+    benchmark_options options;
+    bool custom = false;
+    const char *emit_output = nullptr;
+
+    int pos = 1;
+    while (pos < argc) {
+        std::string_view arg = argv[pos++];
+        if (pos == argc) {
+            std::cerr << "ERROR: " << arg << " requires subsequent argument."
+                      << std::endl;
+            return 1;
+        }
+        std::string value = argv[pos++];
+
+        bool valid = true;
+        if (arg == "--shape") {
+            auto shape = parse_ecosystem_shape(value);
+            valid = shape.has_value();
+            parameters.shape = shape.value_or(parameters.shape);
+            custom = true;
+        } else if (arg == "--packages") {
+            valid = parse_number(value, parameters.packages)
+                && parameters.packages > 0;
+            custom = true;
+        } else if (arg == "--versions") {
+            valid = parse_number(value, parameters.versions)
+                && parameters.versions > 0;
+            custom = true;
+        } else if (arg == "--fan-out") {
+            valid = parse_number(value, parameters.fan_out);
+            custom = true;
+        } else if (arg == "--tightness") {
+            valid = parse_fraction(value, parameters.range_tightness);
+            custom = true;
+        } else if (arg == "--drift") {
+            valid = parse_fraction(value, parameters.lock_drift);
+            custom = true;
+        } else if (arg == "--roots") {
+            valid = parse_number(value, parameters.roots)
+                && parameters.roots > 0;
+            custom = true;
+        } else if (arg == "--seed") {
+            valid = parse_number(value, parameters.seed);
+            custom = true;
+        } else if (arg == "--repeat") {
+            valid = parse_number(value, options.repeat) && options.repeat > 0;
+        } else if (arg == "--jobs") {
+            valid = parse_number(value, options.jobs) && options.jobs > 0;
+        } else if (arg == "--symmetry-reduction") {
+            valid = (value == "on" || value == "off");
+            options.symmetry_reduction = (value == "on");
+        } else if (arg == "--optimization") {
+            valid = (value == "total" || value == "stratified");
+            options.stratified = (value == "stratified");
+        } else if (arg == "--simplify") {
+            valid = (value == "on" || value == "off");
+            options.simplify = (value == "on");
+        } else if (arg == "--engine") {
+            valid = (
+                value == "sat" || value == "pubgrub" || value == "compare"
+            );
+            options.compare = (value == "compare");
+            if (value == "pubgrub") {
+                options.engine = dappi::resolution_engine::pubgrub;
+            }
+        } else if (arg == "--workspace") {
+            valid = (value == "on" || value == "off");
+            options.workspace = (value == "on");
+        } else if (arg == "--update") {
+            valid = parse_number(value, options.updates);
+        } else if (arg == "--conflict-budget") {
+            std::uint64_t budget;
+            valid = parse_number(value, budget);
+            options.limits.conflicts = budget;
+        } else if (arg == "--emit") {
+            emit_output = argv[pos - 1];
+            custom = true;
+        } else {
+            std::cerr << "ERROR: Unrecognized argument - " << arg << std::endl;
+            return 1;
+        }
+
+        if (!valid) {
+            std::cerr << "ERROR: Invalid value for " << arg << " - " << value
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    if (
+        parameters.shape == ecosystem_shape::unsatisfiable
+        && parameters.versions < 2
+    ) {
+        std::cerr << "ERROR: unsatisfiable shape requires 2 or more versions."
+                  << std::endl;
+        return 1;
+    }
+
+    /* Writes the input of "dappi run" instead of running it. */
+    if (emit_output) {
+        auto input = generate_ecosystem(parameters).dump();
+        if (std::string_view(emit_output) == "-") {
+            std::cout << input << std::endl;
+        } else {
+            std::ofstream emit_file(emit_output, std::ios::binary);
+            if (!emit_file) {
+                std::cerr << "ERROR: Failed to open " << emit_output
+                          << " as output." << std::endl;
+                return 1;
+            }
+            emit_file << input << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector<ecosystem_parameters> suite;
+    if (custom) {
+        suite.push_back(parameters);
+    } else {
+        suite = default_suite();
+    }
+
+    std::string engine = "sat";
+    if (options.compare) {
+        engine = "compare";
+    } else if (options.engine == dappi::resolution_engine::pubgrub) {
+        engine = "pubgrub";
+    }
+    nlohmann::json report = {
+        { "engine", engine },
+        { "jobs", options.jobs },
+        { "repeat", options.repeat },
+        { "symmetryReduction", options.symmetry_reduction },
+        {
+            "optimization",
+            options.stratified ? "stratified" : "total"
+        },
+        { "workspace", options.workspace },
+        { "simplify", options.simplify },
+        { "updates", options.updates },
+        { "benchmarks", nlohmann::json::array() }
+    };
+    for (auto &scenario : suite) {
+        auto benchmark = run_benchmark(scenario, options);
+        if (benchmark.is_null()) {
+            return 1;
+        }
+        report["benchmarks"].push_back(std::move(benchmark));
+    }
+    std::cout << report.dump(2) << std::endl;
+
+    return 0;
+}
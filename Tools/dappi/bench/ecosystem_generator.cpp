@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "ecosystem_generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+std::string version_string(std::size_t index) {
+    return "1." + std::to_string(index) + ".0";
+}
+
+class ecosystem_builder {
+public:
+    explicit ecosystem_builder(const ecosystem_parameters &parameters)
+        : M_parameters(parameters),
+          M_random(parameters.seed),
+          M_daps(nlohmann::json::object()),
+          M_names(nlohmann::json::object()) {
+        auto versions = M_parameters.versions;
+        auto tightness = std::clamp(M_parameters.range_tightness, 0.0, 1.0);
+        M_width = versions - static_cast<std::size_t>(
+            std::lround(tightness * static_cast<double>(versions - 1))
+        );
+    }
+
+    std::string add_package(const std::string &key) {
+        auto versions = M_parameters.versions;
+        auto &known = M_names[key]["known"] = nlohmann::json::array();
+        for (std::size_t index = 0; index < versions; ++index) {
+            auto id = dap_id(key, index);
+            known.push_back(id);
+            M_daps[id] = {
+                { "version", version_string(index) },
+                { "dependencies", nlohmann::json::array() }
+            };
+        }
+
+        auto planted = std::uniform_int_distribution<std::size_t>(
+            versions / 2,
+            versions - 1
+        )(M_random);
+        M_planted[key] = planted;
+
+        /* Undrifted locks are the planted solution, which is consistent. */
+        std::bernoulli_distribution drifted(M_parameters.lock_drift);
+        auto locked = planted;
+        if (drifted(M_random)) {
+            locked = std::uniform_int_distribution<std::size_t>(
+                0,
+                versions - 1
+            )(M_random);
+        }
+        M_names[key]["locked"] = dap_id(key, locked);
+        return key;
+    }
+
+    /*
+     * Makes every version of the package depend on the target, requiring a
+     * window of versions which moves forward along with the version.
+     */
+    void add_dependency(const std::string &key, const std::string &target) {
+        auto versions = M_parameters.versions;
+        auto planted = M_planted.at(key);
+        for (std::size_t index = 0; index < versions; ++index) {
+            auto lowest = window_start(index, versions);
+            if (index == planted) {
+                lowest = plant(lowest, target);
+            }
+            add_range(
+                dap_id(key, index),
+                target,
+                lowest,
+                lowest + M_width
+            );
+        }
+    }
+
+    void add_root_dependency(const std::string &target) {
+        auto versions = M_parameters.versions;
+        auto lowest = plant(window_start(versions - 1, versions), target);
+        add_range("ROOT", target, lowest, lowest + M_width);
+    }
+
+    void add_range(
+        const std::string &id,
+        const std::string &target,
+        std::size_t lowest,
+        std::size_t end
+    ) {
+        std::string range = "*";
+        if (end < M_parameters.versions) {
+            range = ">=" + version_string(lowest) + " <" + version_string(end);
+        } else if (lowest > 0) {
+            range = ">=" + version_string(lowest);
+        }
+        M_daps[id]["dependencies"].push_back({
+            { "name", target },
+            { "requiredVersion", range }
+        });
+    }
+
+    std::mt19937 &random() {
+        return M_random;
+    }
+
+    nlohmann::json finish() {
+        M_daps["ROOT"]["version"] = "0.0.0";
+        if (M_parameters.roots > 1) {
+            return finish_workspace();
+        }
+        return {
+            { "entry", "ROOT" },
+            { "names", std::move(M_names) },
+            { "daps", std::move(M_daps) }
+        };
+    }
+
+    /* Splits the requirements of the root into the projects. */
+    nlohmann::json finish_workspace() {
+        auto requirements = std::move(M_daps["ROOT"]["dependencies"]);
+        M_daps.erase("ROOT");
+
+        std::bernoulli_distribution kept(0.5);
+        std::bernoulli_distribution drifted(M_parameters.lock_drift);
+        std::uniform_int_distribution<std::size_t> any_version(
+            0,
+            M_parameters.versions - 1
+        );
+        auto roots = nlohmann::json::object();
+        for (std::size_t index = 0; index < M_parameters.roots; ++index) {
+            auto id = "ROOT" + std::to_string(index);
+            auto dependencies = nlohmann::json::array();
+            for (auto &requirement : requirements) {
+                if (kept(M_random)) {
+                    dependencies.push_back(requirement);
+                }
+            }
+            if (dependencies.empty() && !requirements.empty()) {
+                dependencies.push_back(
+                    requirements[index % requirements.size()]
+                );
+            }
+            M_daps[id] = {
+                { "version", "0.0.0" },
+                { "dependencies", std::move(dependencies) }
+            };
+
+            auto &locked = roots[id]["locked"] = nlohmann::json::object();
+            for (auto &[key, value] : M_names.items()) {
+                auto version = M_planted.at(key);
+                if (drifted(M_random)) {
+                    version = any_version(M_random);
+                }
+                locked[key] = dap_id(key, version);
+            }
+        }
+        for (auto &[key, value] : M_names.items()) {
+            value.erase("locked");
+        }
+
+        return {
+            { "roots", std::move(roots) },
+            { "names", std::move(M_names) },
+            { "daps", std::move(M_daps) }
+        };
+    }
+
+private:
+    static std::string dap_id(const std::string &key, std::size_t index) {
+        return key + "v" + std::to_string(index);
+    }
+
+    std::size_t window_start(std::size_t index, std::size_t versions) {
+        auto slack = M_parameters.versions - M_width;
+        if (slack == 0) {
+            return 0;
+        }
+
+        double position = 1.0;
+        if (versions > 1) {
+            position = static_cast<double>(index)
+                / static_cast<double>(versions - 1);
+        }
+        auto center = static_cast<long>(
+            std::lround(position * static_cast<double>(slack))
+        );
+        center += std::uniform_int_distribution<long>(-1, 1)(M_random);
+        return static_cast<std::size_t>(
+            std::clamp(center, 0L, static_cast<long>(slack))
+        );
+    }
+
+    /*
+     * Moves the window so that it contains the planted version of the target.
+     * As the planted versions always satisfy each other, the ecosystem has at
+     * least one solution unless a conflict is added on purpose.
+     */
+    std::size_t plant(std::size_t lowest, const std::string &target) const {
+        auto planted = M_planted.at(target);
+        if (planted < lowest) {
+            return planted;
+        } else if (planted >= lowest + M_width) {
+            return planted + 1 - M_width;
+        } else {
+            return lowest;
+        }
+    }
+
+    const ecosystem_parameters &M_parameters;
+    std::mt19937 M_random;
+    std::size_t M_width;
+    nlohmann::json M_daps;
+    nlohmann::json M_names;
+
+    /* Version of each package in the known solution */
+    std::unordered_map<std::string, std::size_t> M_planted;
+};
+
+std::string package_key(std::size_t index) {
+    return "p" + std::to_string(index);
+}
+
+void generate_random(
+    ecosystem_builder &builder,
+    const ecosystem_parameters &parameters
+) {
+    auto packages = parameters.packages;
+    for (std::size_t index = 0; index < packages; ++index) {
+        builder.add_package(package_key(index));
+    }
+    for (std::size_t index = 0; index < packages; ++index) {
+        auto remaining = packages - index - 1;
+        std::set<std::size_t> targets;
+        if (remaining <= parameters.fan_out) {
+            for (auto target = index + 1; target < packages; ++target) {
+                targets.insert(target);
+            }
+        } else {
+            std::uniform_int_distribution<std::size_t> pick(
+                index + 1,
+                packages - 1
+            );
+            while (targets.size() < parameters.fan_out) {
+                targets.insert(pick(builder.random()));
+            }
+        }
+        for (auto target : targets) {
+            builder.add_dependency(package_key(index), package_key(target));
+        }
+    }
+
+    auto roots = std::min(parameters.fan_out, packages);
+    for (std::size_t index = 0; index < roots; ++index) {
+        builder.add_root_dependency(package_key(index));
+    }
+}
+
+void generate_chain(
+    ecosystem_builder &builder,
+    const ecosystem_parameters &parameters
+) {
+    auto packages = parameters.packages;
+    for (std::size_t index = 0; index < packages; ++index) {
+        builder.add_package(package_key(index));
+        if (index > 0) {
+            builder.add_dependency(package_key(index - 1), package_key(index));
+        }
+    }
+    builder.add_root_dependency(package_key(0));
+}
+
+void generate_diamond(
+    ecosystem_builder &builder,
+    const ecosystem_parameters &parameters
+) {
+    auto packages = parameters.packages;
+    auto width = std::max<std::size_t>(parameters.fan_out, 2);
+    for (std::size_t index = 0; index < packages; ++index) {
+        builder.add_package(package_key(index));
+    }
+    for (std::size_t index = 0; index < packages; ++index) {
+        auto next_layer = (index / width + 1) * width;
+        for (
+            auto target = next_layer;
+            target < std::min(next_layer + width, packages);
+            ++target
+        ) {
+            builder.add_dependency(package_key(index), package_key(target));
+        }
+    }
+    for (std::size_t index = 0; index < std::min(width, packages); ++index) {
+        builder.add_root_dependency(package_key(index));
+    }
+}
+
+/*
+ * The root requires two more packages, whose versions all require the lower
+ * and the upper half of the last package respectively.
+ */
+void generate_unsatisfiable(
+    ecosystem_builder &builder,
+    const ecosystem_parameters &parameters
+) {
+    generate_random(builder, parameters);
+
+    auto versions = parameters.versions;
+    auto half = versions / 2;
+    auto target = package_key(parameters.packages - 1);
+    for (auto key : { "conflict-a", "conflict-b" }) {
+        builder.add_package(key);
+        builder.add_range("ROOT", key, 0, versions);
+    }
+    for (std::size_t index = 0; index < versions; ++index) {
+        auto suffix = "v" + std::to_string(index);
+        builder.add_range("conflict-a" + suffix, target, 0, half);
+        builder.add_range("conflict-b" + suffix, target, half, versions);
+    }
+}
+
+} // namespace
+
+std::optional<ecosystem_shape> parse_ecosystem_shape(std::string_view str) {
+    for (
+        auto shape : {
+            ecosystem_shape::random,
+            ecosystem_shape::chain,
+            ecosystem_shape::diamond,
+            ecosystem_shape::unsatisfiable
+        }
+    ) {
+        if (str == to_string(shape)) {
+            return shape;
+        }
+    }
+    return std::nullopt;
+}
+
+const char *to_string(ecosystem_shape shape) {
+    switch (shape) {
+    case ecosystem_shape::random:
+        return "random";
+    case ecosystem_shape::chain:
+        return "chain";
+    case ecosystem_shape::diamond:
+        return "diamond";
+    case ecosystem_shape::unsatisfiable:
+        return "unsatisfiable";
+    }
+    return "";
+}
+
+nlohmann::json ecosystem_parameters::to_json() const {
+    return {
+        { "shape", to_string(shape) },
+        { "packages", packages },
+        { "versions", versions },
+        { "fanOut", fan_out },
+        { "rangeTightness", range_tightness },
+        { "lockDrift", lock_drift },
+        { "roots", roots },
+        { "seed", seed }
+    };
+}
+
+nlohmann::json generate_ecosystem(const ecosystem_parameters &parameters) {
+    ecosystem_builder builder(parameters);
+    switch (parameters.shape) {
+    case ecosystem_shape::random:
+        generate_random(builder, parameters);
+        break;
+    case ecosystem_shape::chain:
+        generate_chain(builder, parameters);
+        break;
+    case ecosystem_shape::diamond:
+        generate_diamond(builder, parameters);
+        break;
+    case ecosystem_shape::unsatisfiable:
+        generate_unsatisfiable(builder, parameters);
+        break;
+    }
+    return builder.finish();
+}
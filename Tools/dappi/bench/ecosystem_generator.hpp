@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef ECOSYSTEM_GENERATOR_HPP
+#define ECOSYSTEM_GENERATOR_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+enum class ecosystem_shape {
+    /* Each package depends on packages picked at random further down. */
+    random,
+
+    /* Each package depends on the next one only. */
+    chain,
+
+    /* Layers as wide as the fan-out, each depending on all of the next. */
+    diamond,
+
+    /* Random, plus two packages which require disjoint ranges of a third */
+    unsatisfiable
+};
+
+std::optional<ecosystem_shape> parse_ecosystem_shape(std::string_view str);
+const char *to_string(ecosystem_shape shape);
+
+struct ecosystem_parameters {
+    ecosystem_shape shape = ecosystem_shape::random;
+    std::size_t packages = 1000;
+    std::size_t versions = 10;
+    std::size_t fan_out = 3;
+
+    /* 0 requires any version, 1 requires exactly one version. */
+    double range_tightness = 0.5;
+
+    /*
+     * Fraction of the names locked to a random version instead of the one in
+     * a known solution, as if the lockfile was written long ago.
+     */
+    double lock_drift = 0.1;
+
+    /*
+     * Number of projects of a workspace, each requiring about half of the
+     * packages the root would require and drifting its own locks. 1
+     * generates the root alone.
+     */
+    std::size_t roots = 1;
+
+    std::uint32_t seed = 1;
+
+    nlohmann::json to_json() const;
+};
+
+/*
+ * Generates a resolution problem in the input format of "dappi run". Version
+ * k of every package is 1.k.0, and newer versions tend to require newer
+ * versions of their dependencies.
+ */
+nlohmann::json generate_ecosystem(const ecosystem_parameters &parameters);
+
+#endif
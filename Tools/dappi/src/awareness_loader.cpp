@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "awareness_loader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include "bounded_queue.hpp"
+#include "git_output.hpp"
+
+namespace dappi {
+
+namespace {
+
+/* An object as read by git */
+struct read_object {
+    std::size_t index = 0;
+    std::optional<std::string> content;
+
+    /* git has failed before giving it. */
+    bool failed = false;
+};
+
+struct parsed_object {
+    std::size_t index = 0;
+    loaded_awareness awareness;
+    bool failed = false;
+
+    /* Kept to report what is malformed when strict */
+    std::optional<std::string> content;
+};
+
+/*
+ * Reads the objects of one repository, passing each one to the queue as soon
+ * as it is read. The last one is held until git exits, so that a failure of
+ * git is passed instead. Returns false if the queue has been closed.
+ */
+bool read_repository(
+    const std::string &git,
+    const std::vector<awareness_request> &requests,
+    const std::vector<std::size_t> &indices,
+    const std::string &scratch,
+    bounded_queue<read_object> &objects
+) {
+    std::size_t passed = 0;
+    auto fail = [&] {
+        for (; passed < indices.size(); ++passed) {
+            if (!objects.push({ indices[passed], std::nullopt, true })) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<std::string> names;
+    names.reserve(indices.size());
+    for (auto index : indices) {
+        names.push_back(requests[index].object);
+    }
+    if (!write_requests(scratch, names)) {
+        std::cerr << "ERROR: Failed to write " << scratch << std::endl;
+        return fail();
+    }
+    git_output output(
+        git,
+        requests[indices.front()].git_dir,
+        { "cat-file", "--batch" },
+        &scratch
+    );
+    if (!output.is_open()) {
+        std::cerr << "ERROR: Failed to run " << output.command() << std::endl;
+        return fail();
+    }
+
+    std::optional<read_object> last;
+    std::string header;
+    for (auto index : indices) {
+        if (!output.read_until('\n', header)) {
+            std::cerr << "ERROR: Unexpected end of " << output.command()
+                      << std::endl;
+            return fail();
+        }
+
+        /* "<object> <type> <size>" or "<object> missing" */
+        read_object object;
+        object.index = index;
+        std::istringstream header_stream(header);
+        std::string object_id, type;
+        std::size_t size = 0;
+        if (header_stream >> object_id >> type >> size) {
+            std::string content;
+            content.reserve(size);
+            bool read = output.read_exactly(size, [&](std::string_view chunk) {
+                content.append(chunk);
+            });
+            if (!read || output.get() != '\n') {
+                std::cerr << "ERROR: Unexpected end of " << output.command()
+                          << std::endl;
+                return fail();
+            }
+            if (type == "blob") {
+                object.content = std::move(content);
+            }
+        }
+
+        if (last) {
+            if (!objects.push(std::move(*last))) {
+                return false;
+            }
+            ++passed;
+        }
+        last = std::move(object);
+    }
+    if (!output.close()) {
+        std::cerr << "ERROR: " << output.command() << " failed." << std::endl;
+        return fail();
+    }
+    return objects.push(std::move(*last));
+}
+
+parsed_object parse_object(read_object object, bool strict) {
+    parsed_object result;
+    result.index = object.index;
+    result.failed = object.failed;
+    if (!object.content) {
+        return result;
+    }
+
+    /* Reports are left to the consumer, so that they come in order. */
+    auto &awareness = result.awareness;
+    try {
+        bool well_formed = parse_dependency_awareness(
+            *object.content, false, awareness.da
+        );
+        awareness.status = (
+            well_formed
+            ? awareness_status::parsed
+            : awareness_status::malformed
+        );
+    } catch (std::exception &) {
+        awareness.status = awareness_status::unreadable;
+    }
+    if (strict && awareness.status == awareness_status::malformed) {
+        result.content = std::move(object.content);
+    }
+    return result;
+}
+
+} // namespace
+
+bool load_awareness(
+    const std::string &git,
+    const std::vector<awareness_request> &requests,
+    bool strict,
+    std::size_t jobs,
+    const std::string &scratch,
+    const std::function<bool(std::size_t, loaded_awareness &)> &consumer
+) {
+    if (requests.empty()) {
+        return true;
+    }
+
+    /* Repositories in the order of their first requests */
+    std::vector<std::vector<std::size_t>> repositories;
+    std::unordered_map<std::string, std::size_t> repository_indices;
+    for (std::size_t index = 0; index < requests.size(); ++index) {
+        auto [found, inserted] = repository_indices.emplace(
+            requests[index].git_dir, repositories.size()
+        );
+        if (inserted) {
+            repositories.emplace_back();
+        }
+        repositories[found->second].push_back(index);
+    }
+
+    jobs = std::max<std::size_t>(jobs, 1);
+    auto num_readers = std::min(jobs, repositories.size());
+    bounded_queue<read_object> objects(jobs * 4);
+    bounded_queue<parsed_object> parsed(jobs * 4);
+    std::atomic<std::size_t> next_repository = 0;
+    std::atomic<std::size_t> active_readers = num_readers;
+    std::atomic<std::size_t> active_parsers = jobs;
+
+    std::vector<std::thread> threads;
+    for (std::size_t reader = 0; reader < num_readers; ++reader) {
+        threads.emplace_back([&, reader] {
+            auto reader_scratch = scratch + "." + std::to_string(reader);
+            for (
+                auto repository = next_repository++;
+                repository < repositories.size();
+                repository = next_repository++
+            ) {
+                bool open = read_repository(
+                    git,
+                    requests,
+                    repositories[repository],
+                    reader_scratch,
+                    objects
+                );
+                if (!open) {
+                    break;
+                }
+            }
+            std::remove(reader_scratch.c_str());
+            if (--active_readers == 0) {
+                objects.close();
+            }
+        });
+    }
+    for (std::size_t parser = 0; parser < jobs; ++parser) {
+        threads.emplace_back([&] {
+            while (auto object = objects.pop()) {
+                if (!parsed.push(parse_object(std::move(*object), strict))) {
+                    break;
+                }
+            }
+            if (--active_parsers == 0) {
+                parsed.close();
+            }
+        });
+    }
+
+    /* Objects parsed ahead of their turns */
+    std::map<std::size_t, parsed_object> ahead;
+    bool succeeded = true;
+    for (std::size_t next = 0; succeeded && next < requests.size(); ) {
+        std::optional<parsed_object> object;
+        if (auto found = ahead.find(next); found != ahead.end()) {
+            object = std::move(found->second);
+            ahead.erase(found);
+        } else {
+            object = parsed.pop();
+            if (!object) {
+                succeeded = false;
+                break;
+            } else if (object->index != next) {
+                auto index = object->index;
+                ahead.emplace(index, std::move(*object));
+                continue;
+            }
+        }
+
+        if (object->failed) {
+            succeeded = false;
+            break;
+        }
+        if (object->content) {
+            dependency_awareness da;
+            parse_dependency_awareness(*object->content, true, da);
+        }
+        succeeded = consumer(next++, object->awareness);
+    }
+
+    objects.close();
+    parsed.close();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return succeeded;
+}
+
+} // namespace dappi
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef AWARENESS_LOADER_HPP
+#define AWARENESS_LOADER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "dependency_awareness.hpp"
+
+namespace dappi {
+
+/* An object like "<revision>:DependencyAwareness.yml" in a repository */
+struct awareness_request {
+    std::string git_dir;
+    std::string object;
+};
+
+enum class awareness_status {
+    /* The object is not a blob in the repository. */
+    missing,
+
+    /* The blob is not YAML. */
+    unreadable,
+
+    /* Parts of the document are malformed and skipped. */
+    malformed,
+
+    parsed
+};
+
+struct loaded_awareness {
+    awareness_status status = awareness_status::missing;
+    dependency_awareness da;
+};
+
+/*
+ * Loads DependencyAwareness.yml of many revisions in a pipeline: objects are
+ * read by one `git cat-file --batch` per repository and parsed as soon as
+ * they are read, each stage on up to the given number of threads. Requests to
+ * git are written to files named after the scratch.
+ *
+ * Whatever order they are loaded in, the consumer is called on this thread
+ * for each request in order, and stops the loading by returning false. So are
+ * the reports of malformed documents when strict. Returns false if stopped or
+ * git fails, which is reported to stderr.
+ */
+bool load_awareness(
+    const std::string &git,
+    const std::vector<awareness_request> &requests,
+    bool strict,
+    std::size_t jobs,
+    const std::string &scratch,
+    const std::function<bool(std::size_t, loaded_awareness &)> &consumer
+);
+
+} // namespace dappi
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace dappi {
+
+/*
+ * Queue between stages running on different threads. Producers wait while
+ * it is full, and consumers wait while it is empty until it is closed.
+ */
+template <class T>
+class bounded_queue {
+private:
+    std::mutex M_mutex;
+    std::condition_variable M_not_empty;
+    std::condition_variable M_not_full;
+    std::deque<T> M_items;
+    std::size_t M_capacity;
+    bool M_closed = false;
+
+public:
+    explicit bounded_queue(std::size_t capacity) noexcept
+        : M_capacity(capacity) {
+    }
+
+    /* Returns false, dropping the item, if the queue has been closed. */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(M_mutex);
+        M_not_full.wait(lock, [&] {
+            return M_closed || M_items.size() < M_capacity;
+        });
+        if (M_closed) {
+            return false;
+        }
+        M_items.push_back(std::move(item));
+        M_not_empty.notify_one();
+        return true;
+    }
+
+    /* Returns nullopt once the queue is closed and drained. */
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(M_mutex);
+        M_not_empty.wait(lock, [&] { return M_closed || !M_items.empty(); });
+        if (M_items.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> item = std::move(M_items.front());
+        M_items.pop_front();
+        M_not_full.notify_one();
+        return item;
+    }
+
+    /* Items already queued are still popped. */
+    void close() {
+        std::lock_guard<std::mutex> lock(M_mutex);
+        M_closed = true;
+        M_not_empty.notify_all();
+        M_not_full.notify_all();
+    }
+};
+
+} // namespace dappi
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "dappi.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace dappi {
+
+resolution_limits remaining_limits(
+    const resolution_limits &limits,
+    std::chrono::steady_clock::time_point start
+) {
+    auto result = limits;
+    if (result.time) {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        result.time = std::max(
+            *result.time - elapsed,
+            std::chrono::steady_clock::duration::zero()
+        );
+    }
+    return result;
+}
+
+resolution resolve(
+    resolution_problem &problem,
+    const resolve_options &options
+) {
+    resolution result;
+
+    auto reduction_start = std::chrono::steady_clock::now();
+    if (options.symmetry_reduction) {
+        result.dominated = reduce_symmetries(problem);
+    }
+    result.reduction_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - reduction_start
+    ).count();
+
+    if (options.stratified) {
+        result.strata = stratify(problem);
+    }
+
+    if (options.engine == resolution_engine::pubgrub) {
+        /* It does not optimize, so there is nothing to limit. */
+        auto solver = std::make_unique<version_solver>(problem);
+        result.status = solver->resolve();
+        result.version_result = std::move(solver);
+        return result;
+    }
+
+    auto portfolio = make_portfolio(options.jobs);
+    for (auto &settings : portfolio) {
+        settings.simplify = options.simplify;
+    }
+    result.result = run_portfolio(
+        problem,
+        portfolio,
+        remaining_limits(options.limits, reduction_start),
+        result.reports
+    );
+
+    auto winner = std::find_if(
+        result.reports.begin(),
+        result.reports.end(),
+        [](auto &report) { return report.winner; }
+    );
+    if (winner != result.reports.end()) {
+        result.status = winner->status;
+    }
+    return result;
+}
+
+nlohmann::json resolution::statistics() const {
+    if (result) {
+        return result->statistics().to_json();
+    } else if (version_result) {
+        return {
+            { "versionSolving", version_result->statistics().to_json() }
+        };
+    }
+    return nullptr;
+}
+
+} // namespace dappi
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef DAPPI_HPP
+#define DAPPI_HPP
+
+/*
+ * The API of libdappi, with which tools resolve dependencies in-process on
+ * the same code paths as the dappi executable, without going through files
+ * or the JSON given to "run".
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "dependency_awareness.hpp"
+#include "lockfile.hpp"
+#include "portfolio.hpp"
+#include "resolution_problem.hpp"
+#include "resolver.hpp"
+#include "selection_set.hpp"
+#include "version_solver.hpp"
+
+namespace dappi {
+
+enum class resolution_engine {
+    /* The portfolio of resolvers, which proves the selections optimal */
+    sat,
+
+    /* A version_solver, which decides the locked or newest versions */
+    pubgrub
+};
+
+/* The options of "run" which affect the selection */
+struct resolve_options {
+    resolution_engine engine = resolution_engine::sat;
+    std::size_t jobs = 1;
+    bool symmetry_reduction = true;
+    bool stratified = false;
+    bool simplify = false;
+    resolution_limits limits;
+};
+
+struct resolution {
+    /*
+     * The instance which has won, to be asked for the selections. It is
+     * nullptr if the pubgrub engine has run.
+     */
+    std::unique_ptr<resolver> result;
+
+    /* The solver of the pubgrub engine, nullptr if the sat one has run */
+    std::unique_ptr<version_solver> version_result;
+
+    /*
+     * Of the winner or the version solver. The winner is not optimal if the
+     * limits have run out, and the version solver is feasible at best.
+     */
+    std::optional<resolution_status> status;
+
+    std::vector<instance_report> reports;
+    std::size_t dominated = 0;
+    std::size_t strata = 1;
+    double reduction_seconds = 0;
+
+    /* The selections of the engine which has run, if any */
+    const selection_set *selections() const noexcept {
+        if (result) {
+            return result.get();
+        }
+        return version_result.get();
+    }
+
+    /* Statistics of the engine which has run, null without selections */
+    nlohmann::json statistics() const;
+};
+
+/*
+ * Returns the limits left of the given ones since the start, for the time
+ * spent on the way to resolve().
+ */
+resolution_limits remaining_limits(
+    const resolution_limits &limits,
+    std::chrono::steady_clock::time_point start
+);
+
+/*
+ * Does what "run" does after parsing its input: reduces symmetries and
+ * assigns strata as the options tell, which modifies the problem, then runs
+ * the portfolio on it. The problem must outlive the result.
+ */
+resolution resolve(
+    resolution_problem &problem,
+    const resolve_options &options
+);
+
+} // namespace dappi
+
+#endif
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "dependency_awareness.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include "restricted_yaml.hpp"
+
+namespace dappi {
+
+namespace {
+
+std::pair<required_dependency, bool> parse_dependency(
+    const YAML::Node &name,
+    const YAML::Node &value,
+    bool strict
+) {
+    required_dependency result;
+    bool well_formed = true;
+    if (value.Type() == YAML::NodeType::Map) {
+        result.name = name.as<std::string>();
+
+        auto require_node = value["require"];
+        if (require_node) {
+            switch (require_node.Type()) {
+            case YAML::NodeType::Scalar:
+                result.require = require_node.as<std::string>();
+                break;
+            default:
+                if (strict) {
+                    std::cerr << "ERROR: require is not a scalar."
+                              << std::endl;
+                }
+                well_formed = false;
+                break;
+            }
+        }
+
+        auto location_node = value["location"];
+        if (location_node) {
+            switch (location_node.Type()) {
+            case YAML::NodeType::Scalar:
+                result.locations = { location_node.as<std::string>() };
+                break;
+            case YAML::NodeType::Sequence:
+                result.locations.reserve(location_node.size());
+                for (auto elem : location_node) {
+                    if (elem.Type() == YAML::NodeType::Scalar) {
+                        result.locations.push_back(elem.as<std::string>());
+                    } else {
+                        if (strict) {
+                            std::cerr << "ERROR: A location is not a scalar."
+                                      << std::endl;
+                        }
+                        well_formed = false;
+                    }
+                }
+                break;
+            default:
+                if (strict) {
+                    std::cerr << "ERROR: location is invalid." << std::endl;
+                }
+                well_formed = false;
+                break;
+            }
+        }
+    } else {
+        if (strict) {
+            std::cerr << "ERROR: A dependency is not a map." << std::endl;
+        }
+        well_formed = false;
+    }
+    return std::make_pair(std::move(result), well_formed);
+}
+
+/*
+ * Reads the document if it is well-formed. Otherwise returns false, leaving
+ * the document to yaml-cpp so that the same errors are reported.
+ */
+bool scan_dependency_awareness(
+    const restricted_yaml &doc,
+    dependency_awareness &result
+) {
+    using node_type = restricted_yaml::node_type;
+    constexpr auto none = restricted_yaml::none;
+
+    auto &root = doc.root();
+    if (root.type != node_type::map) {
+        return false;
+    }
+
+    bool has_name = false;
+    bool has_version = false;
+    bool has_dependencies = false;
+    for (auto index = root.first_child; index != none;) {
+        auto &entry = doc.at(index);
+        index = entry.next_sibling;
+        if (entry.key == "name") {
+            if (has_name || entry.type != node_type::scalar) {
+                return false;
+            }
+            has_name = true;
+            result.name = entry.value;
+        } else if (entry.key == "version") {
+            if (has_version || entry.type != node_type::scalar) {
+                return false;
+            }
+            has_version = true;
+            result.version = entry.value;
+        } else if (entry.key == "dependencies") {
+            if (has_dependencies || entry.type != node_type::map) {
+                return false;
+            }
+            has_dependencies = true;
+            for (auto child = entry.first_child; child != none;) {
+                auto &dep = doc.at(child);
+                child = dep.next_sibling;
+                if (dep.type != node_type::map) {
+                    return false;
+                }
+                auto &new_dep = result.dependencies.emplace_back();
+                new_dep.name = dep.key;
+
+                bool has_require = false;
+                bool has_location = false;
+                for (auto next = dep.first_child; next != none;) {
+                    auto &field = doc.at(next);
+                    next = field.next_sibling;
+                    if (field.key == "require") {
+                        if (has_require || field.type != node_type::scalar) {
+                            return false;
+                        }
+                        has_require = true;
+                        new_dep.require = field.value;
+                    } else if (field.key == "location") {
+                        if (has_location) {
+                            return false;
+                        }
+                        has_location = true;
+                        if (field.type == node_type::scalar) {
+                            new_dep.locations.emplace_back(field.value);
+                            continue;
+                        } else if (field.type != node_type::sequence) {
+                            return false;
+                        }
+                        for (auto elem = field.first_child; elem != none;) {
+                            auto &location = doc.at(elem);
+                            elem = location.next_sibling;
+                            if (location.type != node_type::scalar) {
+                                return false;
+                            }
+                            new_dep.locations.emplace_back(location.value);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool parse_dependency_awareness(
+    const YAML::Node &doc,
+    bool strict,
+    dependency_awareness &result
+) {
+    auto &name = result.name;
+    auto &version = result.version;
+    auto &dependencies = result.dependencies;
+
+    bool well_formed = true;
+    if (doc.Type() == YAML::NodeType::Map) {
+        auto name_node = doc["name"];
+        if (name_node) {
+            switch (name_node.Type()) {
+            case YAML::NodeType::Scalar:
+                name = name_node.as<std::string>();
+                break;
+            default:
+                if (strict) {
+                    std::cerr << "ERROR: name is not a scalar." << std::endl;
+                }
+                well_formed = false;
+                break;
+            }
+        }
+
+        auto version_node = doc["version"];
+        if (version_node) {
+            switch (version_node.Type()) {
+            case YAML::NodeType::Scalar:
+                version = version_node.as<std::string>();
+                break;
+            default:
+                if (strict) {
+                    std::cerr << "ERROR: version is not a scalar."
+                              << std::endl;
+                }
+                well_formed = false;
+                break;
+            }
+        }
+
+        auto deps_node = doc["dependencies"];
+        if (deps_node) {
+            switch (deps_node.Type()) {
+            case YAML::NodeType::Map:
+                for (auto dep_node : deps_node) {
+                    auto [new_dep, valid] = parse_dependency(
+                        dep_node.first,
+                        dep_node.second,
+                        strict
+                    );
+                    if (valid) {
+                        dependencies.push_back(std::move(new_dep));
+                    } else {
+                        well_formed = false;
+                    }
+                }
+                break;
+            default:
+                if (strict) {
+                    std::cerr << "ERROR: dependencies is not a map."
+                              << std::endl;
+                }
+                well_formed = false;
+                break;
+            }
+        }
+    } else {
+        if (strict) {
+            std::cerr << "ERROR: The document is not a map." << std::endl;
+        }
+        well_formed = false;
+    }
+    return well_formed;
+}
+
+bool parse_dependency_awareness(
+    std::string_view text,
+    bool strict,
+    dependency_awareness &result
+) {
+    restricted_yaml doc;
+    dependency_awareness scanned;
+    if (doc.parse(text) && scan_dependency_awareness(doc, scanned)) {
+        result = std::move(scanned);
+        return true;
+    }
+    return parse_dependency_awareness(
+        YAML::Load(std::string(text)),
+        strict,
+        result
+    );
+}
+
+} // namespace dappi
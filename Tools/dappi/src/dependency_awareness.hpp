@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef DEPENDENCY_AWARENESS_HPP
+#define DEPENDENCY_AWARENESS_HPP
+
+#include <list>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace dappi {
+
+struct required_dependency {
+    std::string name;
+    std::string require;
+    std::vector<std::string> locations;
+};
+
+/* The content of DependencyAwareness.yml of a revision */
+struct dependency_awareness {
+    std::string name;
+    std::string version;
+    std::list<required_dependency> dependencies;
+};
+
+/*
+ * Reads the document into result, skipping the parts which are malformed.
+ * Returns false if any part is, which is reported only when strict.
+ */
+bool parse_dependency_awareness(
+    const YAML::Node &doc,
+    bool strict,
+    dependency_awareness &result
+);
+
+/*
+ * Reads the document from its text like above. Documents within the subset
+ * of restricted_yaml are read in place, and the others through yaml-cpp,
+ * which throws if the text is not YAML.
+ */
+bool parse_dependency_awareness(
+    std::string_view text,
+    bool strict,
+    dependency_awareness &result
+);
+
+} // namespace dappi
+
+#endif
@@ -23,16 +23,17 @@
 
 #include "general_violation_counters.hpp"
 
-#include "violation_counter_merger.hpp"
+namespace dappi {
 
 violation_counter_set make_general_violation_counters(
-    Minisat::Solver &solver,
-    const std::vector<Minisat::Var> &violations
+    Minisat::SimpSolver &solver,
+    const std::vector<Minisat::Var> &violations,
+    merge_order order
 ) {
     if (violations.empty()) {
         return violation_counter_set({});
     } else {
-        violation_counter_merger work;
+        violation_counter_merger work(order);
         for (auto violation : violations) {
             work.add(violation_counter_set({ violation }));
         }
@@ -40,3 +41,5 @@ violation_counter_set make_general_violation_counters(
         return work.release();
     }
 }
+
+} // namespace dappi
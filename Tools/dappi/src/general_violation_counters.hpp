@@ -25,12 +25,18 @@
 #define GENERAL_VIOLATION_COUNTERS_HPP
 
 #include <vector>
-#include <minisat/core/Solver.h>
+#include <minisat/simp/SimpSolver.h>
+#include "violation_counter_merger.hpp"
 #include "violation_counter_set.hpp"
 
+namespace dappi {
+
 violation_counter_set make_general_violation_counters(
-    Minisat::Solver &solver,
-    const std::vector<Minisat::Var> &violations
+    Minisat::SimpSolver &solver,
+    const std::vector<Minisat::Var> &violations,
+    merge_order order = merge_order::smallest_first
 );
 
+} // namespace dappi
+
 #endif
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "git_output.hpp"
+
+#include <fstream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace dappi {
+
+namespace {
+
+std::string shell_quote(std::string_view arg) {
+#ifdef _WIN32
+    std::string result = "\"";
+    for (char c : arg) {
+        if (c == '"') {
+            result += '\\';
+        }
+        result += c;
+    }
+    result += '"';
+#else
+    std::string result = "'";
+    for (char c : arg) {
+        if (c == '\'') {
+            result += "'\\''";
+        } else {
+            result += c;
+        }
+    }
+    result += '\'';
+#endif
+    return result;
+}
+
+} // namespace
+
+void git_output::closer::operator ()(std::FILE *stream) const noexcept {
+    pclose(stream);
+}
+
+git_output::git_output(
+    const std::string &git,
+    const std::string &git_dir,
+    const std::vector<std::string> &args,
+    const std::string *input
+) {
+    M_command = shell_quote(git) + " -C " + shell_quote(git_dir);
+    for (auto &arg : args) {
+        M_command += ' ';
+        M_command += shell_quote(arg);
+    }
+    if (input) {
+        M_command += " < " + shell_quote(*input);
+    }
+#ifdef _WIN32
+    M_stream.reset(popen(M_command.c_str(), "rb"));
+#else
+    M_stream.reset(popen(M_command.c_str(), "r"));
+#endif
+}
+
+bool git_output::read_until(char delimiter, std::string &result) {
+    result.clear();
+    int c;
+    while ((c = std::fgetc(M_stream.get())) != EOF) {
+        if (c == delimiter) {
+            return true;
+        }
+        result += static_cast<char>(c);
+    }
+    return !result.empty();
+}
+
+bool git_output::close() {
+    return (pclose(M_stream.release()) == 0);
+}
+
+bool write_requests(
+    const std::string &scratch,
+    const std::vector<std::string> &objects
+) {
+    std::ofstream requests(scratch, std::ios::binary);
+    for (auto &object : objects) {
+        requests << object << '\n';
+    }
+    return static_cast<bool>(requests);
+}
+
+} // namespace dappi
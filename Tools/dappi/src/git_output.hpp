@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef GIT_OUTPUT_HPP
+#define GIT_OUTPUT_HPP
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dappi {
+
+/* Output of a git command, read as it is produced */
+class git_output {
+private:
+    struct closer {
+        void operator ()(std::FILE *stream) const noexcept;
+    };
+
+    std::unique_ptr<std::FILE, closer> M_stream;
+    std::string M_command;
+
+public:
+    /* Runs git in the directory, giving the input file as its stdin. */
+    git_output(
+        const std::string &git,
+        const std::string &git_dir,
+        const std::vector<std::string> &args,
+        const std::string *input = nullptr
+    );
+
+    const std::string &command() const noexcept {
+        return M_command;
+    }
+
+    bool is_open() const noexcept {
+        return static_cast<bool>(M_stream);
+    }
+
+    /* Reads until the delimiter, which is dropped. */
+    bool read_until(char delimiter, std::string &result);
+
+    int get() {
+        return std::fgetc(M_stream.get());
+    }
+
+    /* Passes exactly the given number of bytes to the consumer in chunks. */
+    template <class Consumer>
+    bool read_exactly(std::size_t size, Consumer &&consumer) {
+        char buffer[65536];
+        while (size > 0) {
+            auto chunk = std::min(size, sizeof(buffer));
+            auto read = std::fread(buffer, 1, chunk, M_stream.get());
+            if (read == 0) {
+                return false;
+            }
+            consumer(std::string_view(buffer, read));
+            size -= read;
+        }
+        return true;
+    }
+
+    /* Returns whether git has succeeded. */
+    bool close();
+};
+
+/* Writes the objects into the file, one per line, for `git cat-file`. */
+bool write_requests(
+    const std::string &scratch,
+    const std::vector<std::string> &objects
+);
+
+} // namespace dappi
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "interrupt_timer.hpp"
+
+namespace dappi {
+
+interrupt_timer::interrupt_timer(std::chrono::steady_clock::duration timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    M_thread = std::thread([this, deadline]() {
+        std::unique_lock<std::mutex> lock(M_mutex);
+        if (
+            !M_condition.wait_until(
+                lock,
+                deadline,
+                [this]() { return M_cancelled; }
+            )
+        ) {
+            M_expired = true;
+            for (auto target : M_targets) {
+                target->expire();
+            }
+        }
+    });
+}
+
+interrupt_timer::~interrupt_timer() {
+    {
+        std::lock_guard<std::mutex> lock(M_mutex);
+        M_cancelled = true;
+    }
+    M_condition.notify_all();
+    M_thread.join();
+}
+
+void interrupt_timer::watch(resolver &target) {
+    std::lock_guard<std::mutex> lock(M_mutex);
+    if (M_expired) {
+        target.expire();
+    } else {
+        M_targets.push_back(&target);
+    }
+}
+
+} // namespace dappi
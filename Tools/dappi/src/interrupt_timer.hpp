@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef INTERRUPT_TIMER_HPP
+#define INTERRUPT_TIMER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "resolver.hpp"
+
+namespace dappi {
+
+/*
+ * Expires every watched resolver once the timeout elapses, so that ones
+ * minimizing are interrupted. Resolvers must outlive the timer.
+ */
+class interrupt_timer {
+private:
+    std::mutex M_mutex;
+    std::condition_variable M_condition;
+    bool M_cancelled = false;
+    bool M_expired = false;
+    std::vector<resolver *> M_targets;
+    std::thread M_thread;
+
+public:
+    explicit interrupt_timer(std::chrono::steady_clock::duration timeout);
+    ~interrupt_timer();
+
+    interrupt_timer(const interrupt_timer &) = delete;
+    interrupt_timer &operator =(const interrupt_timer &) = delete;
+
+    void watch(resolver &target);
+};
+
+} // namespace dappi
+
+#endif
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "lockfile.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include "restricted_yaml.hpp"
+
+namespace dappi {
+
+namespace {
+
+/*
+ * Reads the lockfile if it is well-formed. Otherwise returns false, leaving
+ * the lockfile to yaml-cpp so that the same errors are reported.
+ */
+bool scan_lockfile(const restricted_yaml &doc, lockfile &result) {
+    using node_type = restricted_yaml::node_type;
+    constexpr auto none = restricted_yaml::none;
+
+    auto &root = doc.root();
+    if (root.type != node_type::map) {
+        return false;
+    }
+
+    const restricted_yaml::node *version = nullptr;
+    const restricted_yaml::node *packages = nullptr;
+    for (auto index = root.first_child; index != none;) {
+        auto &entry = doc.at(index);
+        if (entry.key == "version") {
+            if (version) {
+                return false;
+            }
+            version = &entry;
+        } else if (entry.key == "packages") {
+            if (packages) {
+                return false;
+            }
+            packages = &entry;
+        }
+        index = entry.next_sibling;
+    }
+    if (
+        !version
+        || version->type != node_type::scalar
+        || version->value != "1"
+        || !packages
+        || packages->type != node_type::map
+    ) {
+        return false;
+    }
+
+    for (auto index = packages->first_child; index != none;) {
+        auto &package = doc.at(index);
+        index = package.next_sibling;
+        if (package.type != node_type::map) {
+            return false;
+        }
+
+        const restricted_yaml::node *fields[4] = {};
+        static const std::string_view field_keys[4] = {
+            "version", "location", "integrity", "dependencies"
+        };
+        for (auto field = package.first_child; field != none;) {
+            auto &entry = doc.at(field);
+            for (std::size_t key = 0; key < 4; ++key) {
+                if (entry.key == field_keys[key]) {
+                    if (fields[key]) {
+                        return false;
+                    }
+                    fields[key] = &entry;
+                }
+            }
+            field = entry.next_sibling;
+        }
+        auto [version_node, location_node, integrity_node, deps_node] =
+            fields;
+        if (
+            !version_node
+            || version_node->type != node_type::scalar
+            || !location_node
+            || location_node->type != node_type::scalar
+            || !integrity_node
+            || integrity_node->type != node_type::map
+            || (deps_node && deps_node->type != node_type::sequence)
+        ) {
+            return false;
+        }
+
+        locked_package new_package;
+        new_package.version = semver::version(version_node->value);
+        new_package.location = location_node->value;
+
+        bool has_algorithm = false;
+        bool has_digest = false;
+        for (auto field = integrity_node->first_child; field != none;) {
+            auto &entry = doc.at(field);
+            field = entry.next_sibling;
+            if (entry.key == "algorithm") {
+                if (has_algorithm || entry.type != node_type::scalar) {
+                    return false;
+                }
+                has_algorithm = true;
+                new_package.integrity.algorithm = entry.value;
+            } else if (entry.key == "digest") {
+                if (has_digest || entry.type != node_type::scalar) {
+                    return false;
+                }
+                has_digest = true;
+                new_package.integrity.digest = entry.value;
+            }
+        }
+        if (!has_algorithm || !has_digest) {
+            return false;
+        }
+
+        if (deps_node) {
+            for (auto dep = deps_node->first_child; dep != none;) {
+                auto &entry = doc.at(dep);
+                if (entry.type != node_type::scalar) {
+                    return false;
+                }
+                new_package.dependencies.emplace(entry.value);
+                dep = entry.next_sibling;
+            }
+        }
+
+        result.emplace(package.key, std::move(new_package));
+    }
+    return true;
+}
+
+} // namespace
+
+bool parse_lockfile(const YAML::Node &doc, lockfile &result) {
+    if (doc.Type() != YAML::NodeType::Map) {
+        std::cerr << "ERROR: The document is not a map." << std::endl;
+        return false;
+    }
+
+    if (auto version_node = doc["version"]; version_node) {
+        switch (version_node.Type()) {
+        case YAML::NodeType::Scalar:
+            if (int version = version_node.as<int>(); version != 1) {
+                std::cerr << "ERROR: Unknown version - " << version
+                          << std::endl;
+                return false;
+            }
+            break;
+        default:
+            std::cerr << "ERROR: version is not a scalar." << std::endl;
+            return false;
+        }
+    } else {
+        std::cerr << "ERROR: version does not exist." << std::endl;
+        return false;
+    }
+
+    auto packages_node = doc["packages"];
+    if (!packages_node) {
+        std::cerr << "ERROR: packages does not exist." << std::endl;
+        return false;
+    } else if (packages_node.Type() != YAML::NodeType::Map) {
+        std::cerr << "ERROR: packages is not a map." << std::endl;
+        return false;
+    }
+
+    for (auto package : packages_node) {
+        auto name = package.first.as<std::string>();
+        locked_package new_package;
+
+        auto &body = package.second;
+        if (body.Type() != YAML::NodeType::Map) {
+            std::cerr << "ERROR: package " << name << " is not a map."
+                      << std::endl;
+            return false;
+        }
+
+        if (auto version_node = body["version"]; version_node) {
+            if (version_node.Type() == YAML::NodeType::Scalar) {
+                new_package.version = semver::version(
+                    version_node.as<std::string>()
+                );
+            } else {
+                std::cerr << "ERROR: version of package " << name
+                          << " is not a scalar." << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "ERROR: version of package " << name
+                      << " does not exist." << std::endl;
+            return false;
+        }
+
+        if (auto location_node = body["location"]; location_node) {
+            if (location_node.Type() == YAML::NodeType::Scalar) {
+                new_package.location = location_node.as<std::string>();
+            } else {
+                std::cerr << "ERROR: location of package " << name
+                          << " is not a scalar." << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "ERROR: location of package " << name
+                      << " does not exist." << std::endl;
+            return false;
+        }
+
+        if (auto integrity_node = body["integrity"]; integrity_node) {
+            if (integrity_node.Type() != YAML::NodeType::Map) {
+                std::cerr << "ERROR: integrity of package " << name
+                          << " is not a map." << std::endl;
+                return false;
+            }
+
+            if (auto node = integrity_node["algorithm"]; node) {
+                if (node.Type() != YAML::NodeType::Scalar) {
+                    std::cerr << "ERROR: integrity algorithm of package "
+                              << name << " is not a scalar." << std::endl;
+                    return false;
+                }
+                new_package.integrity.algorithm = node.as<std::string>();
+            } else {
+                std::cerr << "ERROR: integrity algorithm of package " << name
+                          << " does not exist." << std::endl;
+                return false;
+            }
+
+            if (auto node = integrity_node["digest"]; node) {
+                if (node.Type() != YAML::NodeType::Scalar) {
+                    std::cerr << "ERROR: integrity digest of package "
+                              << name << " is not a scalar." << std::endl;
+                    return false;
+                }
+                new_package.integrity.digest = node.as<std::string>();
+            } else {
+                std::cerr << "ERROR: integrity digest of package " << name
+                          << " does not exist." << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "ERROR: integrity of package " << name
+                      << " does not exist." << std::endl;
+            return false;
+        }
+
+        if (auto deps_node = body["dependencies"]; deps_node) {
+            if (deps_node.Type() != YAML::NodeType::Sequence) {
+                std::cerr << "ERROR: dependencies of package " << name
+                          << " is not a sequence." << std::endl;
+                return false;
+            }
+            for (auto dep : deps_node) {
+                if (dep.Type() != YAML::NodeType::Scalar) {
+                    std::cerr << "ERROR: a dependency from package " << name
+                              << " is not a scalar." << std::endl;
+                    return false;
+                }
+                new_package.dependencies.insert(dep.as<std::string>());
+            }
+        }
+
+        result.emplace(name, std::move(new_package));
+    }
+
+    return true;
+}
+
+bool parse_lockfile(std::string_view text, lockfile &result) {
+    restricted_yaml doc;
+    lockfile scanned;
+    if (doc.parse(text) && scan_lockfile(doc, scanned)) {
+        result = std::move(scanned);
+        return true;
+    }
+    return parse_lockfile(YAML::Load(std::string(text)), result);
+}
+
+std::string emit_lockfile(const lockfile &packages) {
+    YAML::Emitter emitter;
+    emitter << YAML::DoubleQuoted
+            << YAML::BeginMap
+            << YAML::Key << "version"
+            << YAML::Value << 1
+            << YAML::Key << "packages"
+            << YAML::Value << YAML::BeginMap;
+
+    for (auto &[name, package] : packages) {
+        emitter << YAML::Key << name
+                << YAML::Value << YAML::BeginMap
+                << YAML::Key << "version"
+                << YAML::Value << package.version.to_string()
+                << YAML::Key << "location"
+                << YAML::Value << package.location
+                << YAML::Key << "integrity"
+                << YAML::Value << YAML::BeginMap
+                << YAML::Key << "algorithm"
+                << YAML::Value << package.integrity.algorithm
+                << YAML::Key << "digest"
+                << YAML::Value << package.integrity.digest
+                << YAML::EndMap;
+        if (!package.dependencies.empty()) {
+            emitter << YAML::Key << "dependencies"
+                    << YAML::Value << YAML::BeginSeq;
+            for (auto &dependency : package.dependencies) {
+                emitter << dependency;
+            }
+            emitter << YAML::EndSeq;
+        }
+        emitter << YAML::EndMap;
+    }
+
+    emitter << YAML::EndMap << YAML::EndMap << YAML::Newline;
+    return emitter.c_str();
+}
+
+bool write_lockfile(const char *filename, const lockfile &packages) {
+    std::string body = emit_lockfile(packages);
+
+    std::filebuf file;
+    file.open(filename, std::ios::in | std::ios::binary);
+    if (file.is_open()) {
+        auto size = file.pubseekoff(0, std::ios::end);
+        if (size == body.length()) {
+            std::string original;
+            original.resize(body.length());
+            file.pubseekpos(0);
+            if (
+                file.sgetn(original.data(), body.length()) == body.length()
+                && original == body
+            ) {
+                /* The lockfile is identical. */
+                return true;
+            }
+        }
+        file.close();
+    }
+
+    file.open(filename, std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Failed to open " << filename << " as output."
+                  << std::endl;
+        return false;
+    }
+    file.sputn(body.data(), body.length());
+    return true;
+}
+
+} // namespace dappi
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef LOCKFILE_HPP
+#define LOCKFILE_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <semver.hpp>
+#include <yaml-cpp/yaml.h>
+
+namespace dappi {
+
+struct integrity_t {
+    std::string algorithm;
+    std::string digest;
+};
+
+struct locked_package {
+    semver::version version;
+    std::string location;
+    integrity_t integrity;
+    std::set<std::string> dependencies;
+};
+
+/* The packages of a lockfile by their names */
+using lockfile = std::map<std::string, locked_package>;
+
+/*
+ * Reads a lockfile of version 1 into result. Returns false after reporting
+ * the first malformed part.
+ */
+bool parse_lockfile(const YAML::Node &doc, lockfile &result);
+
+/*
+ * Reads the lockfile from its text like above. Lockfiles as written by
+ * write_lockfile() are read in place by restricted_yaml, and the others
+ * through yaml-cpp, which throws if the text is not YAML.
+ */
+bool parse_lockfile(std::string_view text, lockfile &result);
+
+/* Returns the content of the lockfile, which is the same for equal ones. */
+std::string emit_lockfile(const lockfile &packages);
+
+/*
+ * Writes the lockfile unless the file has the same content already, so that
+ * its timestamp only changes along with the locks.
+ */
+bool write_lockfile(const char *filename, const lockfile &packages);
+
+} // namespace dappi
+
+#endif
@@ -21,206 +21,85 @@
  *    distribution.
  */
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
-#include <list>
 #include <map>
 #include <optional>
 #include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 #include <nlohmann/json.hpp>
 #include <yaml-cpp/yaml.h>
 #include <semver.hpp>
-#include <minisat/core/Solver.h>
-#include "general_violation_counters.hpp"
-#include "violation_counter_merger.hpp"
+#include "awareness_loader.hpp"
+#include "dappi.hpp"
+#include "registry_index.hpp"
+#include "server.hpp"
 
 namespace {
 
-struct required_dependency {
-    std::string name;
-    std::string require;
-    std::vector<std::string> locations;
-};
-
-struct integrity_t {
-    std::string algorithm;
-    std::string digest;
-};
-
-struct locked_package {
-    semver::version version;
-    std::string location;
-    integrity_t integrity;
-    std::set<std::string> dependencies;
-};
-
 struct dap {
-    Minisat::Var var;
     semver::version version;
     std::string location;
-    std::optional<integrity_t> integrity;
+    std::optional<dappi::integrity_t> integrity;
     std::set<std::string> dependencies;
 };
 
 using dap_map_t = std::unordered_map<std::string, dap>;
 
-struct named_dap {
-    Minisat::Var var;
-    dap_map_t::iterator referenced_dap;
-};
-
-struct name {
-    dap_map_t::iterator selection;
-    std::vector<named_dap> candidates;
-};
-
-std::pair<required_dependency, bool> parse_dependency(
-    const YAML::Node &name,
-    const YAML::Node &value,
-    bool strict
-) {
-    required_dependency result;
-    bool well_formed = true;
-    if (value.Type() == YAML::NodeType::Map) {
-        result.name = name.as<std::string>();
-
-        auto require_node = value["require"];
-        if (require_node) {
-            switch (require_node.Type()) {
-            case YAML::NodeType::Scalar:
-                result.require = require_node.as<std::string>();
-                break;
-            default:
-                if (strict) {
-                    std::cerr << "ERROR: require is not a scalar."
-                              << std::endl;
-                }
-                well_formed = false;
-                break;
-            }
-        }
+template <class T>
+bool parse_number(std::string_view str, T &value) {
+    auto [end, error] = std::from_chars(
+        str.data(),
+        str.data() + str.size(),
+        value
+    );
+    return (error == std::errc() && end == str.data() + str.size());
+}
 
-        auto location_node = value["location"];
-        if (location_node) {
-            switch (location_node.Type()) {
-            case YAML::NodeType::Scalar:
-                result.locations = { location_node.as<std::string>() };
-                break;
-            case YAML::NodeType::Sequence:
-                result.locations.reserve(location_node.size());
-                for (auto elem : location_node) {
-                    if (elem.Type() == YAML::NodeType::Scalar) {
-                        result.locations.push_back(elem.as<std::string>());
-                    } else {
-                        if (strict) {
-                            std::cerr << "ERROR: A location is not a scalar."
-                                      << std::endl;
-                        }
-                        well_formed = false;
-                    }
-                }
-                break;
-            default:
-                if (strict) {
-                    std::cerr << "ERROR: location is invalid." << std::endl;
-                }
-                well_formed = false;
-                break;
-            }
-        }
-    } else {
-        if (strict) {
-            std::cerr << "ERROR: A dependency is not a map." << std::endl;
-        }
-        well_formed = false;
+/* Reads the whole file at once, which the parsers refer into. */
+bool read_file(const char *filename, std::string &content) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    auto size = file.tellg();
+    if (size < 0) {
+        return false;
     }
-    return std::make_pair(std::move(result), well_formed);
+    content.resize(static_cast<std::size_t>(size));
+    file.seekg(0);
+    return static_cast<bool>(file.read(content.data(), content.size()));
 }
 
 int load_da(const char *filename, bool strict) {
-    YAML::Node doc;
+    std::string text;
+    dappi::dependency_awareness da;
+    bool well_formed;
+    if (!read_file(filename, text)) {
+        std::cerr << "ERROR: Failed to read YAML from " << filename
+                  << std::endl;
+        return 1;
+    }
     try {
-        doc = YAML::LoadFile(filename);
+        well_formed = dappi::parse_dependency_awareness(text, strict, da);
     } catch (std::exception &) {
         std::cerr << "ERROR: Failed to read YAML from " << filename
                   << std::endl;
         return 1;
     }
 
-    std::string name;
-    std::string version;
-    std::list<required_dependency> dependencies;
-
-    bool well_formed = true;
-    if (doc.Type() == YAML::NodeType::Map) {
-        auto name_node = doc["name"];
-        if (name_node) {
-            switch (name_node.Type()) {
-            case YAML::NodeType::Scalar:
-                name = name_node.as<std::string>();
-                break;
-            default:
-                if (strict) {
-                    std::cerr << "ERROR: name is not a scalar." << std::endl;
-                }
-                well_formed = false;
-                break;
-            }
-        }
-
-        auto version_node = doc["version"];
-        if (version_node) {
-            switch (version_node.Type()) {
-            case YAML::NodeType::Scalar:
-                version = version_node.as<std::string>();
-                break;
-            default:
-                if (strict) {
-                    std::cerr << "ERROR: version is not a scalar."
-                              << std::endl;
-                }
-                well_formed = false;
-                break;
-            }
-        }
-
-        auto deps_node = doc["dependencies"];
-        if (deps_node) {
-            switch (deps_node.Type()) {
-            case YAML::NodeType::Map:
-                for (auto dep_node : deps_node) {
-                    auto [new_dep, valid] = parse_dependency(
-                        dep_node.first,
-                        dep_node.second,
-                        strict
-                    );
-                    if (valid) {
-                        dependencies.push_back(std::move(new_dep));
-                    } else {
-                        well_formed = false;
-                    }
-                }
-                break;
-            default:
-                if (strict) {
-                    std::cerr << "ERROR: dependencies is not a map."
-                              << std::endl;
-                }
-                well_formed = false;
-                break;
-            }
-        }
-    } else {
-        if (strict) {
-            std::cerr << "ERROR: The document is not a map." << std::endl;
-        }
-        well_formed = false;
-    }
-
     if (well_formed) {
+        const auto &[name, version, dependencies] = da;
 
         /* TODO : Escape CMake strings */
 
@@ -259,160 +138,440 @@ int load_da(const char *filename, bool strict) {
 }
 
 int load_dal(const char *filename, bool /* strict */) {
-    YAML::Node doc;
+    std::string text;
+    dappi::lockfile locked_packages;
+    bool well_formed;
+    if (!read_file(filename, text)) {
+        std::cerr << "ERROR: Failed to read YAML from " << filename
+                  << std::endl;
+        return 1;
+    }
     try {
-        doc = YAML::LoadFile(filename);
+        well_formed = dappi::parse_lockfile(text, locked_packages);
     } catch (std::exception &) {
         std::cerr << "ERROR: Failed to read YAML from " << filename
                   << std::endl;
         return 1;
     }
-
-    if (doc.Type() != YAML::NodeType::Map) {
-        std::cerr << "ERROR: The document is not a map." << std::endl;
+    if (!well_formed) {
         return 1;
     }
 
-    if (auto version_node = doc["version"]; version_node) {
-        switch (version_node.Type()) {
-        case YAML::NodeType::Scalar:
-            if (int version = version_node.as<int>(); version != 1) {
-                std::cerr << "ERROR: Unknown version - " << version
-                          << std::endl;
-                return 1;
+    for (auto &[name, body] : locked_packages) {
+
+        /* TODO : Escape CMake strings */
+
+        std::cout << "DAPPI_LOCK(" << std::endl
+                  << "  NAME " << name << std::endl
+                  << "  VERSION " << body.version.to_string() << std::endl
+                  << "  LOCATION \"" << body.location << "\"" << std::endl
+                  << "  INTEGRITY" << std::endl
+                  << "    ALGORITHM " << body.integrity.algorithm << std::endl
+                  << "    DIGEST " << body.integrity.digest << std::endl
+                  << ")" << std::endl;
+    }
+
+    return 0;
+}
+
+std::string cmake_quote(std::string_view value) {
+    std::string result = "\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"' || c == '$') {
+            result += '\\';
+        }
+        result += c;
+    }
+    result += '"';
+    return result;
+}
+
+void emit_set_property(
+    std::ostream &out,
+    std::string_view property,
+    std::string_view value
+) {
+    out << "set_property (GLOBAL PROPERTY " << cmake_quote(property) << ' '
+        << cmake_quote(value) << ")\n";
+}
+
+/* DAPs declared by a batch, which are emitted as one script */
+struct dap_batch {
+    std::vector<std::string> dap_ids;
+    std::vector<std::string> declaration_ids;
+    std::ostringstream properties;
+};
+
+/*
+ * Declares the DAP of a revision peeked as the object, which is
+ * "<revision>:DependencyAwareness.yml". Returns false if the batch fails.
+ */
+bool declare_peeked_dap(
+    dap_batch &batch,
+    const std::string &dap_id,
+    const std::string &object,
+    const std::string &url,
+    const std::string &source_dir,
+    const dappi::loaded_awareness &awareness,
+    bool strict
+) {
+    auto &properties = batch.properties;
+    batch.dap_ids.push_back(dap_id);
+
+    std::string dap_prefix = "Dapper::DAPs::" + dap_id + "::";
+    emit_set_property(properties, dap_prefix + "URL", url);
+    emit_set_property(
+        properties, dap_prefix + "Fragment", object.substr(0, object.rfind(':'))
+    );
+    emit_set_property(properties, dap_prefix + "SourceDir", source_dir);
+
+    switch (awareness.status) {
+    case dappi::awareness_status::unreadable:
+        std::cerr << "ERROR: Failed to read YAML from " << object << std::endl;
+        return false;
+    case dappi::awareness_status::malformed:
+        if (strict) {
+            return false;
+        }
+        [[fallthrough]];
+    case dappi::awareness_status::missing:
+        /* This revision is to be skipped. */
+        emit_set_property(properties, dap_prefix + "Declarations", "");
+        return true;
+    case dappi::awareness_status::parsed:
+        break;
+    }
+
+    auto &da = awareness.da;
+    emit_set_property(properties, dap_prefix + "Name", da.name);
+    emit_set_property(properties, dap_prefix + "Version", da.version);
+    std::string declarations;
+    std::size_t index = 0;
+    for (const auto &dep : da.dependencies) {
+        if (dep.require.empty() && dep.locations.empty()) {
+            std::cerr << "ERROR: Either REQUIRE or LOCATION is needed."
+                      << std::endl;
+            return false;
+        }
+        std::string id = dap_id + "_" + std::to_string(index++);
+        std::string locations;
+        for (const auto &location : dep.locations) {
+            if (!locations.empty()) {
+                locations += ';';
             }
-            break;
-        default:
-            std::cerr << "ERROR: version is not a scalar." << std::endl;
-            return 1;
+            locations += location;
         }
-    } else {
-        std::cerr << "ERROR: version does not exist." << std::endl;
-        return 1;
+        std::string prefix = "Dapper::Declarations::" + id + "::";
+        emit_set_property(properties, prefix + "From", url + "#" + object);
+        emit_set_property(properties, prefix + "Name", dep.name);
+        emit_set_property(properties, prefix + "RequiredVersion", dep.require);
+        emit_set_property(properties, prefix + "KnownLocations", locations);
+
+        if (!declarations.empty()) {
+            declarations += ';';
+        }
+        declarations += id;
+        batch.declaration_ids.push_back(std::move(id));
     }
+    emit_set_property(properties, dap_prefix + "Declarations", declarations);
+    return true;
+}
 
-    auto packages_node = doc["packages"];
-    if (!packages_node) {
-        std::cerr << "ERROR: packages does not exist." << std::endl;
+void emit_dap_batch(const dap_batch &batch) {
+    /* Declared up front, as the driver does before peeking each of them */
+    for (const auto &[property, ids] : {
+        std::make_pair("Dapper::DAPs", &batch.dap_ids),
+        std::make_pair("Dapper::Declarations", &batch.declaration_ids)
+    }) {
+        if (ids->empty()) {
+            continue;
+        }
+        std::cout << "set_property (GLOBAL APPEND PROPERTY " << property;
+        for (const auto &id : *ids) {
+            std::cout << "\n  " << cmake_quote(id);
+        }
+        std::cout << "\n)\n";
+    }
+    std::cout << batch.properties.str();
+}
+
+/*
+ * Reads the output of `git cat-file --batch` for DependencyAwareness.yml of
+ * several revisions of a repository, and emits one script which declares all
+ * of their DAPs at once. Each line of requests_filename is the object name
+ * given to git, "<revision>:DependencyAwareness.yml", followed by the DAP id.
+ */
+int load_da_batch(
+    const char *filename,
+    const char *requests_filename,
+    const std::string &url,
+    const std::string &source_dir,
+    bool strict
+) {
+    std::ifstream batch_file(filename, std::ios::binary);
+    if (!batch_file) {
+        std::cerr << "ERROR: Failed to open " << filename << std::endl;
         return 1;
-    } else if (packages_node.Type() != YAML::NodeType::Map) {
-        std::cerr << "ERROR: packages is not a map." << std::endl;
+    }
+    std::ifstream requests(requests_filename);
+    if (!requests) {
+        std::cerr << "ERROR: Failed to open " << requests_filename
+                  << std::endl;
         return 1;
     }
 
-    std::map<std::string, locked_package> locked_packages;
-    for (auto package : packages_node) {
-        auto name = package.first.as<std::string>();
-        locked_package new_package;
-
-        auto &body = package.second;
-        if (body.Type() != YAML::NodeType::Map) {
-            std::cerr << "ERROR: package " << name << " is not a map."
-                      << std::endl;
-            return 1;
+    dap_batch batch;
+    std::string request;
+    while (std::getline(requests, request)) {
+        if (request.empty()) {
+            continue;
         }
-
-        if (auto version_node = body["version"]; version_node) {
-            if (version_node.Type() == YAML::NodeType::Scalar) {
-                new_package.version = semver::version(
-                    version_node.as<std::string>()
-                );
-            } else {
-                std::cerr << "ERROR: version of package " << name
-                          << " is not a scalar." << std::endl;
-                return 1;
-            }
-        } else {
-            std::cerr << "ERROR: version of package " << name
-                      << " does not exist." << std::endl;
+        auto id_pos = request.rfind(' ');
+        auto revision_pos = request.rfind(':', id_pos);
+        if (id_pos == std::string::npos || revision_pos == std::string::npos) {
+            std::cerr << "ERROR: Invalid request - " << request << std::endl;
             return 1;
         }
+        std::string dap_id = request.substr(id_pos + 1);
+        std::string object = request.substr(0, id_pos);
 
-        if (auto location_node = body["location"]; location_node) {
-            if (location_node.Type() == YAML::NodeType::Scalar) {
-                new_package.location = location_node.as<std::string>();
-            } else {
-                std::cerr << "ERROR: location of package " << name
-                          << " is not a scalar." << std::endl;
-                return 1;
-            }
-        } else {
-            std::cerr << "ERROR: location of package " << name
-                      << " does not exist." << std::endl;
+        /* "<object> <type> <size>..." or "<object> missing" */
+        std::string header;
+        if (!std::getline(batch_file, header)) {
+            std::cerr << "ERROR: Unexpected end of " << filename << std::endl;
             return 1;
         }
-
-        if (auto integrity_node = body["integrity"]; integrity_node) {
-            if (integrity_node.Type() != YAML::NodeType::Map) {
-                std::cerr << "ERROR: integrity of package " << name
-                          << " is not a map." << std::endl;
+        std::istringstream header_stream(header);
+        std::string object_id, type;
+        std::size_t size = 0;
+        dappi::loaded_awareness awareness;
+        if (header_stream >> object_id >> type >> size) {
+            std::string buffer(size, '\0');
+            if (
+                !batch_file.read(buffer.data(), size)
+                || batch_file.get() != '\n'
+            ) {
+                std::cerr << "ERROR: Unexpected end of " << filename
+                          << std::endl;
                 return 1;
             }
-
-            if (auto node = integrity_node["algorithm"]; node) {
-                if (node.Type() != YAML::NodeType::Scalar) {
-                    std::cerr << "ERROR: integrity algorithm of package "
-                              << name << " is not a scalar." << std::endl;
-                    return 1;
+            if (type == "blob") {
+                try {
+                    bool well_formed = dappi::parse_dependency_awareness(
+                        buffer, strict, awareness.da
+                    );
+                    awareness.status = (
+                        well_formed
+                        ? dappi::awareness_status::parsed
+                        : dappi::awareness_status::malformed
+                    );
+                } catch (std::exception &) {
+                    awareness.status = dappi::awareness_status::unreadable;
                 }
-                new_package.integrity.algorithm = node.as<std::string>();
-            } else {
-                std::cerr << "ERROR: integrity algorithm of package " << name
-                          << " does not exist." << std::endl;
-                return 1;
             }
+        }
 
-            if (auto node = integrity_node["digest"]; node) {
-                if (node.Type() != YAML::NodeType::Scalar) {
-                    std::cerr << "ERROR: integrity digest of package "
-                              << name << " is not a scalar." << std::endl;
-                    return 1;
-                }
-                new_package.integrity.digest = node.as<std::string>();
-            } else {
-                std::cerr << "ERROR: integrity digest of package " << name
-                          << " does not exist." << std::endl;
-                return 1;
-            }
-        } else {
-            std::cerr << "ERROR: integrity of package " << name
-                      << " does not exist." << std::endl;
+        bool declared = declare_peeked_dap(
+            batch, dap_id, object, url, source_dir, awareness, strict
+        );
+        if (!declared) {
             return 1;
         }
+    }
 
-        if (auto deps_node = body["dependencies"]; deps_node) {
-            if (deps_node.Type() != YAML::NodeType::Sequence) {
-                std::cerr << "ERROR: dependencies of package " << name
-                          << " is not a sequence." << std::endl;
-                return 1;
-            }
-            for (auto dep : deps_node) {
-                if (dep.Type() != YAML::NodeType::Scalar) {
-                    std::cerr << "ERROR: a dependency from package " << name
-                              << " is not a scalar." << std::endl;
-                    return 1;
-                }
-                new_package.dependencies.insert(dep.as<std::string>());
-            }
+    emit_dap_batch(batch);
+    return 0;
+}
+
+/*
+ * Loads DependencyAwareness.yml of revisions of several repositories like
+ * load_da_batch, reading them with git and parsing them on several threads.
+ * Each line of requests_filename is "<source dir>\t<url>\t<object> <DAP id>".
+ * DAPs are emitted in the order of the requests.
+ */
+int load_da_repos(
+    const char *requests_filename,
+    const std::string &git,
+    std::size_t jobs,
+    bool strict
+) {
+    std::ifstream requests_file(requests_filename);
+    if (!requests_file) {
+        std::cerr << "ERROR: Failed to open " << requests_filename
+                  << std::endl;
+        return 1;
+    }
+
+    std::vector<dappi::awareness_request> requests;
+    std::vector<std::string> urls;
+    std::vector<std::string> dap_ids;
+    std::string request;
+    while (std::getline(requests_file, request)) {
+        if (request.empty()) {
+            continue;
+        }
+        auto url_pos = request.find('\t');
+        auto object_pos = request.find('\t', url_pos + 1);
+        auto id_pos = request.rfind(' ');
+        auto revision_pos = request.rfind(':', id_pos);
+        if (
+            object_pos == std::string::npos
+            || id_pos == std::string::npos
+            || revision_pos == std::string::npos
+            || revision_pos < object_pos
+        ) {
+            std::cerr << "ERROR: Invalid request - " << request << std::endl;
+            return 1;
         }
+        requests.push_back({
+            request.substr(0, url_pos),
+            request.substr(object_pos + 1, id_pos - object_pos - 1)
+        });
+        urls.push_back(request.substr(url_pos + 1, object_pos - url_pos - 1));
+        dap_ids.push_back(request.substr(id_pos + 1));
+    }
 
-        locked_packages.emplace(name, std::move(new_package));
+    dap_batch batch;
+    bool loaded = dappi::load_awareness(
+        git,
+        requests,
+        strict,
+        jobs,
+        std::string(requests_filename) + ".git",
+        [&](std::size_t index, dappi::loaded_awareness &awareness) {
+            return declare_peeked_dap(
+                batch,
+                dap_ids[index],
+                requests[index].object,
+                urls[index],
+                requests[index].git_dir,
+                awareness,
+                strict
+            );
+        }
+    );
+    if (!loaded) {
+        return 1;
     }
 
-    for (auto &[name, body] : locked_packages) {
+    emit_dap_batch(batch);
+    return 0;
+}
 
-        /* TODO : Escape CMake strings */
+/*
+ * Emits the registry index of a host as properties keyed by locations on the
+ * host, from which the driver declares DAPs without cloning repositories.
+ */
+int load_index(const char *filename, const std::string &host) {
+    YAML::Node doc;
+    try {
+        doc = YAML::LoadFile(filename);
+    } catch (std::exception &) {
+        std::cerr << "ERROR: Failed to read YAML from " << filename
+                  << std::endl;
+        return 1;
+    }
 
-        std::cout << "DAPPI_LOCK(" << std::endl
-                  << "  NAME " << name << std::endl
-                  << "  VERSION " << body.version.to_string() << std::endl
-                  << "  LOCATION \"" << body.location << "\"" << std::endl
-                  << "  INTEGRITY" << std::endl
-                  << "    ALGORITHM " << body.integrity.algorithm << std::endl
-                  << "    DIGEST " << body.integrity.digest << std::endl
-                  << ")" << std::endl;
+    auto repositories = doc["repositories"];
+    if (repositories && repositories.Type() != YAML::NodeType::Map) {
+        std::cerr << "ERROR: repositories is not a map." << std::endl;
+        return 1;
     }
 
+    std::ostringstream properties;
+    try {
+        for (auto repository : repositories) {
+            std::string prefix = "Dapper::Index::" + host + ":"
+                + repository.first.as<std::string>() + "::";
+            std::string tags;
+            for (auto tag : repository.second["tags"]) {
+                auto tag_name = tag.first.as<std::string>();
+                if (!tags.empty()) {
+                    tags += ';';
+                }
+                tags += tag_name;
+
+                std::string tag_prefix = prefix + tag_name + "::";
+                auto &entry = tag.second;
+                emit_set_property(
+                    properties,
+                    tag_prefix + "Commit",
+                    entry["commit"].as<std::string>()
+                );
+
+                auto integrity = entry["integrity"];
+                if (
+                    integrity
+                    && integrity["algorithm"].as<std::string>() == "sha512"
+                ) {
+                    emit_set_property(
+                        properties,
+                        tag_prefix + "Digest",
+                        integrity["digest"].as<std::string>()
+                    );
+                }
+
+                /* Revisions without awareness are to be skipped. */
+                dappi::dependency_awareness da;
+                auto awareness = entry["awareness"];
+                if (
+                    !awareness
+                    || !dappi::parse_dependency_awareness(
+                        awareness, false, da
+                    )
+                ) {
+                    continue;
+                }
+                bool declarable = std::all_of(
+                    da.dependencies.begin(),
+                    da.dependencies.end(),
+                    [](auto &dep) {
+                        return !dep.require.empty() || !dep.locations.empty();
+                    }
+                );
+                if (!declarable) {
+                    continue;
+                }
+
+                emit_set_property(properties, tag_prefix + "Name", da.name);
+                emit_set_property(
+                    properties, tag_prefix + "Version", da.version
+                );
+                emit_set_property(
+                    properties,
+                    tag_prefix + "Dependencies",
+                    std::to_string(da.dependencies.size())
+                );
+                std::size_t index = 0;
+                for (const auto &dep : da.dependencies) {
+                    std::string dep_prefix = tag_prefix + "Dependency::"
+                        + std::to_string(index++) + "::";
+                    std::string locations;
+                    for (const auto &location : dep.locations) {
+                        if (!locations.empty()) {
+                            locations += ';';
+                        }
+                        locations += location;
+                    }
+                    emit_set_property(
+                        properties, dep_prefix + "Name", dep.name
+                    );
+                    emit_set_property(
+                        properties, dep_prefix + "RequiredVersion", dep.require
+                    );
+                    emit_set_property(
+                        properties, dep_prefix + "KnownLocations", locations
+                    );
+                }
+            }
+            emit_set_property(properties, prefix + "Tags", tags);
+        }
+    } catch (std::exception &) {
+        std::cerr << "ERROR: Invalid registry index - " << filename
+                  << std::endl;
+        return 1;
+    }
+    std::cout << properties.str();
     return 0;
 }
 
@@ -420,6 +579,15 @@ int load(int argc, char *argv[]) {
     bool strict = false;
     const char *input = nullptr;
     int (*loader)(const char *, bool) = nullptr;
+    bool batch = false;
+    bool repos = false;
+    const char *requests = nullptr;
+    std::string git = "git";
+    std::size_t jobs = std::max(std::thread::hardware_concurrency(), 1u);
+    std::string url;
+    std::string source_dir;
+    bool index = false;
+    std::string host;
 
     int pos = 0;
     while (pos < argc) {
@@ -437,8 +605,17 @@ int load(int argc, char *argv[]) {
                 std::string_view type_str = argv[pos++];
                 if (type_str == "da") {
                     loader = load_da;
+                } else if (type_str == "da-batch") {
+                    loader = load_da;
+                    batch = true;
+                } else if (type_str == "da-repos") {
+                    loader = load_da;
+                    repos = true;
                 } else if (type_str == "dal") {
                     loader = load_dal;
+                } else if (type_str == "index") {
+                    loader = load_da;
+                    index = true;
                 } else {
                     std::cerr << "ERROR: Unknown type - " << type_str
                               << std::endl;
@@ -457,6 +634,53 @@ int load(int argc, char *argv[]) {
             } else {
                 input = argv[pos++];
             }
+        } else if (arg == "--requests") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --requests requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            requests = argv[pos++];
+        } else if (arg == "--url") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --url requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            url = argv[pos++];
+        } else if (arg == "--source-dir") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --source-dir requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            source_dir = argv[pos++];
+        } else if (arg == "--host") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --host requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            host = argv[pos++];
+        } else if (arg == "--git") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --git requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            git = argv[pos++];
+        } else if (arg == "--jobs") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --jobs requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            std::string_view jobs_str = argv[pos++];
+            if (!parse_number(jobs_str, jobs) || jobs == 0) {
+                std::cerr << "ERROR: Invalid number of jobs - " << jobs_str
+                          << std::endl;
+                return 1;
+            }
         } else if (arg == "--strict") {
             strict = true;
         } else {
@@ -465,12 +689,36 @@ int load(int argc, char *argv[]) {
         }
     }
 
+    /* Objects are read from the repositories. */
+    if (repos) {
+        if (!requests) {
+            std::cerr << "ERROR: --requests option is mandatory for da-repos."
+                      << std::endl;
+            return 1;
+        }
+        return load_da_repos(requests, git, jobs, strict);
+    }
+
     if (!input) {
         std::cerr << "ERROR: -i option is mandatory." << std::endl;
         return 1;
     }
 
-    if (loader) {
+    if (batch) {
+        if (!requests) {
+            std::cerr << "ERROR: --requests option is mandatory for da-batch."
+                      << std::endl;
+            return 1;
+        }
+        return load_da_batch(input, requests, url, source_dir, strict);
+    } else if (index) {
+        if (host.empty()) {
+            std::cerr << "ERROR: --host option is mandatory for index."
+                      << std::endl;
+            return 1;
+        }
+        return load_index(input, host);
+    } else if (loader) {
         return loader(input, strict);
     } else {
         std::cerr << "ERROR: -t option is mandatory." << std::endl;
@@ -537,7 +785,7 @@ int save(int argc, char *argv[]) {
 
             auto integrity_it = value.find("integrity");
             if (integrity_it != value.end()) {
-                integrity_t integrity;
+                dappi::integrity_t integrity;
 
                 auto algorithm_it = integrity_it->find("algorithm");
                 if (algorithm_it != integrity_it->end()) {
@@ -588,14 +836,7 @@ int save(int argc, char *argv[]) {
         }
     }
 
-    YAML::Emitter lockfile;
-    lockfile << YAML::DoubleQuoted
-             << YAML::BeginMap
-             << YAML::Key << "version"
-             << YAML::Value << 1
-             << YAML::Key << "packages"
-             << YAML::Value << YAML::BeginMap;
-
+    dappi::lockfile packages;
     for (auto &[name, dap_it] : names) {
         auto &referenced_dap = dap_it->second;
         if (!referenced_dap.integrity) {
@@ -603,66 +844,263 @@ int save(int argc, char *argv[]) {
                       << " is blank." << std::endl;
             return 1;
         }
-        lockfile << YAML::Key << name
-                 << YAML::Value << YAML::BeginMap
-                 << YAML::Key << "version"
-                 << YAML::Value << referenced_dap.version.to_string()
-                 << YAML::Key << "location"
-                 << YAML::Value << referenced_dap.location
-                 << YAML::Key << "integrity"
-                 << YAML::Value << YAML::BeginMap
-                 << YAML::Key << "algorithm"
-                 << YAML::Value << referenced_dap.integrity->algorithm
-                 << YAML::Key << "digest"
-                 << YAML::Value << referenced_dap.integrity->digest
-                 << YAML::EndMap;
-        if (!referenced_dap.dependencies.empty()) {
-            lockfile << YAML::Key << "dependencies"
-                     << YAML::Value << YAML::BeginSeq;
-            for (auto &name : referenced_dap.dependencies) {
-                lockfile << name;
-            }
-            lockfile << YAML::EndSeq;
-        }
-        lockfile << YAML::EndMap;
+        packages.emplace(name, dappi::locked_package{
+            referenced_dap.version,
+            referenced_dap.location,
+            *referenced_dap.integrity,
+            referenced_dap.dependencies
+        });
+    }
+
+    if (!dappi::write_lockfile(output, packages)) {
+        return 1;
     }
+    return 0;
+}
 
-    lockfile << YAML::EndMap << YAML::EndMap << YAML::Newline;
+/*
+ * "index build -o FILE [--git GIT] PATH=GIT_DIR..." writes the registry index
+ * of the bare repositories, each at the path of its location on the host.
+ * Without "PATH=", the name of the directory without ".git" is the path.
+ */
+int index_repositories(int argc, char *argv[]) {
+    if (argc == 0 || std::string_view(argv[0]) != "build") {
+        std::cerr << "ERROR: index requires build." << std::endl;
+        return 1;
+    }
 
-    std::string output_body = lockfile.c_str();
+    const char *output = nullptr;
+    std::string git = "git";
+    std::vector<dappi::index_source> sources;
 
-    std::filebuf output_file;
-    output_file.open(output, std::ios::in | std::ios::binary);
-    if (output_file.is_open()) {
-        auto size = output_file.pubseekoff(0, std::ios::end);
-        if (size == output_body.length()) {
-            std::string original;
-            original.resize(output_body.length());
-            output_file.pubseekpos(0);
-            if (
-                output_file.sgetn(original.data(), output_body.length())
-                == output_body.length()
-                && original == output_body
-            ) {
-                /* The lockfile is identical. */
-                return 0;
+    int pos = 1;
+    while (pos < argc) {
+        std::string_view arg = argv[pos++];
+        if (arg == "-o") {
+            if (output) {
+                std::cerr << "ERROR: More than one -o are specified."
+                          << std::endl;
+                return 1;
+            } else if (pos == argc) {
+                std::cerr << "ERROR: -o requires subsequent argument."
+                          << std::endl;
+                return 1;
+            } else {
+                output = argv[pos++];
+            }
+        } else if (arg == "--git") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --git requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            git = argv[pos++];
+        } else {
+            dappi::index_source source;
+            auto separator = arg.find('=');
+            if (separator == std::string_view::npos) {
+                source.git_dir = arg;
+                std::string_view path = arg;
+                while (!path.empty() && path.back() == '/') {
+                    path.remove_suffix(1);
+                }
+                path = path.substr(path.find_last_of('/') + 1);
+                if (
+                    path.size() > 4
+                    && path.substr(path.size() - 4) == ".git"
+                ) {
+                    path.remove_suffix(4);
+                }
+                source.path = path;
+            } else {
+                source.path = arg.substr(0, separator);
+                source.git_dir = arg.substr(separator + 1);
+            }
+            if (source.path.empty() || source.git_dir.empty()) {
+                std::cerr << "ERROR: Invalid repository - " << arg
+                          << std::endl;
+                return 1;
             }
+            sources.push_back(std::move(source));
         }
-        output_file.close();
     }
 
-    output_file.open(output, std::ios::out | std::ios::binary);
-    if (!output_file.is_open()) {
-        std::cerr << "ERROR: Failed to open " << output << " as output."
-                  << std::endl;
+    if (!output) {
+        std::cerr << "ERROR: -o option is mandatory." << std::endl;
+        return 1;
+    }
+
+    YAML::Emitter index_file;
+    std::string scratch = std::string(output) + ".requests";
+    bool built = dappi::build_registry_index(
+        git, sources, scratch, index_file
+    );
+    std::remove(scratch.c_str());
+    if (!built) {
         return 1;
     }
-    output_file.sputn(output_body.data(), output_body.length());
 
+    /* Written aside and renamed, as drivers may be reading the index. */
+    std::string tmp_output = std::string(output) + ".tmp";
+    {
+        std::ofstream output_file(tmp_output, std::ios::binary);
+        if (!output_file) {
+            std::cerr << "ERROR: Failed to open " << tmp_output
+                      << " as output." << std::endl;
+            return 1;
+        }
+        output_file << index_file.c_str();
+    }
+    if (
+        std::rename(tmp_output.c_str(), output) != 0
+        && (
+            std::remove(output) != 0
+            || std::rename(tmp_output.c_str(), output) != 0
+        )
+    ) {
+        std::cerr << "ERROR: Failed to write " << output << std::endl;
+        return 1;
+    }
     return 0;
 }
 
-int run(int, char *[]) {
+int run(int argc, char *argv[]) {
+    dappi::resolve_options options;
+    std::size_t frontier_size = 0;
+    const char *stats_output = nullptr;
+    std::set<std::string_view> updates;
+
+    int pos = 0;
+    while (pos < argc) {
+        std::string_view arg = argv[pos++];
+        if (arg == "--no-symmetry-reduction") {
+            options.symmetry_reduction = false;
+        } else if (arg == "--engine") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --engine requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            std::string_view engine = argv[pos++];
+            if (engine == "sat") {
+                options.engine = dappi::resolution_engine::sat;
+            } else if (engine == "pubgrub") {
+                options.engine = dappi::resolution_engine::pubgrub;
+            } else {
+                std::cerr << "ERROR: Invalid engine - " << engine << std::endl;
+                return 1;
+            }
+        } else if (arg == "--simplify") {
+            options.simplify = true;
+        } else if (arg == "--update") {
+            /* Names follow up to the next option. */
+            auto first = pos;
+            while (
+                pos < argc
+                && std::string_view(argv[pos]).substr(0, 2) != "--"
+            ) {
+                updates.emplace(argv[pos++]);
+            }
+            if (pos == first) {
+                std::cerr << "ERROR: --update requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+        } else if (arg == "--optimization") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --optimization requires subsequent "
+                          << "argument." << std::endl;
+                return 1;
+            }
+            std::string_view mode = argv[pos++];
+            if (mode == "total") {
+                options.stratified = false;
+            } else if (mode == "stratified") {
+                options.stratified = true;
+            } else {
+                std::cerr << "ERROR: Invalid optimization - " << mode
+                          << std::endl;
+                return 1;
+            }
+        } else if (arg == "--jobs") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --jobs requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            std::string_view jobs_str = argv[pos++];
+            if (!parse_number(jobs_str, options.jobs) || options.jobs == 0) {
+                std::cerr << "ERROR: Invalid number of jobs - " << jobs_str
+                          << std::endl;
+                return 1;
+            }
+        } else if (arg == "--frontier") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --frontier requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            std::string_view size_str = argv[pos++];
+            if (!parse_number(size_str, frontier_size)) {
+                std::cerr << "ERROR: Invalid frontier size - " << size_str
+                          << std::endl;
+                return 1;
+            }
+        } else if (arg == "--stats") {
+            if (stats_output) {
+                std::cerr << "ERROR: More than one --stats are specified."
+                          << std::endl;
+                return 1;
+            } else if (pos == argc) {
+                std::cerr << "ERROR: --stats requires subsequent argument."
+                          << std::endl;
+                return 1;
+            } else {
+                stats_output = argv[pos++];
+            }
+        } else if (arg == "--conflict-budget") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --conflict-budget requires subsequent "
+                          << "argument." << std::endl;
+                return 1;
+            }
+            std::string_view budget_str = argv[pos++];
+            std::uint64_t budget;
+            if (!parse_number(budget_str, budget)) {
+                std::cerr << "ERROR: Invalid conflict budget - " << budget_str
+                          << std::endl;
+                return 1;
+            }
+            options.limits.conflicts = budget;
+        } else if (arg == "--time-limit") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --time-limit requires subsequent "
+                          << "argument." << std::endl;
+                return 1;
+            }
+            std::string limit_str = argv[pos++];
+            char *end = nullptr;
+            double seconds = std::strtod(limit_str.c_str(), &end);
+            if (
+                limit_str.empty()
+                || *end != '\0'
+                || !(seconds >= 0)
+            ) {
+                std::cerr << "ERROR: Invalid time limit - " << limit_str
+                          << std::endl;
+                return 1;
+            }
+            options.limits.time = std::chrono::duration_cast<
+                std::chrono::steady_clock::duration
+            >(std::chrono::duration<double>(seconds));
+        } else {
+            std::cerr << "ERROR: Unrecognized argument - " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    auto parse_start = std::chrono::steady_clock::now();
+
     nlohmann::json state;
     try {
         std::cin >> state;
@@ -671,326 +1109,253 @@ int run(int, char *[]) {
         return 1;
     }
 
-    Minisat::Solver resolution;
-    dap_map_t daps;
-    std::unordered_map<std::string, name> names;
+    auto problem = dappi::parse_resolution_problem(state);
+    if (!problem) {
+        return 1;
+    }
 
-    auto daps_it = state.find("daps");
-    if (daps_it != state.end()) {
-        for (auto &[key, value] : daps_it->items()) {
-            dap new_dap;
-            new_dap.var = resolution.newVar();
+    /* Names not known yet are left to the later iterations. */
+    for (auto &this_name : problem->names) {
+        this_name.updating = (updates.count(this_name.key) > 0);
+    }
 
-            auto version_it = value.find("version");
-            if (version_it != value.end()) {
-                new_dap.version = semver::version(
-                    version_it->template get<std::string>()
-                );
+    auto parse_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - parse_start
+    ).count();
+
+    /* Reading the input counts in the time limit as well. */
+    options.limits = dappi::remaining_limits(options.limits, parse_start);
+    auto resolution = dappi::resolve(*problem, options);
+    auto &reports = resolution.reports;
+    auto &result = resolution.result;
+    auto selections = resolution.selections();
+
+    if (options.jobs > 1) {
+        for (std::size_t index = 0; index < reports.size(); ++index) {
+            auto &report = reports[index];
+            std::cerr << "INFO: Instance " << index << " ("
+                      << report.settings.describe() << "): ";
+            if (report.winner) {
+                std::cerr << "won";
+            } else if (
+                report.status
+                && *report.status != dappi::resolution_status::interrupted
+            ) {
+                std::cerr << "finished";
+            } else {
+                std::cerr << "cancelled";
             }
-
-            daps.emplace(key, std::move(new_dap));
+            std::cerr << " after " << report.seconds << "s, "
+                      << report.solves << " solves, "
+                      << report.conflicts << " conflicts, "
+                      << report.decisions << " decisions, "
+                      << report.propagations << " propagations"
+                      << std::endl;
         }
     }
 
-    violation_counter_merger penalty_groups;
-    std::vector<Minisat::Var> unlocks;
-
-    auto names_it = state.find("names");
-    if (names_it != state.end()) {
-        for (auto &[key, value] : names_it->items()) {
-            name new_name;
-            new_name.selection = daps.end();
-
-            auto selected_it = value.find("selected");
-            if (selected_it != value.end()) {
-                auto id = selected_it->template get<std::string>();
-                auto found_dap = daps.find(id);
-                if (found_dap == daps.end()) {
-                    std::cerr << "ERROR: DAP " << id << " not defined."
-                              << std::endl;
-                    return 1;
-                } else {
-                    new_name.selection = found_dap;
-                }
-            }
+    if (stats_output) {
+        auto stats = resolution.statistics();
+        if (result) {
+            auto &solver = result->solver();
+            stats["solver"] = {
+                { "vars", solver.nVars() },
+                { "clauses", solver.nClauses() },
+                { "solves", solver.solves },
+                { "conflicts", solver.conflicts },
+                { "decisions", solver.decisions },
+                { "propagations", solver.propagations }
+            };
+        }
+        stats["phases"]["parse"] = { { "seconds", parse_seconds } };
+        stats["phases"]["symmetryReduction"] = {
+            { "seconds", resolution.reduction_seconds }
+        };
+        stats["problem"] = {
+            { "daps", problem->daps.size() },
+            { "names", problem->names.size() },
+            { "roots", problem->roots.size() },
+            { "dominated", resolution.dominated },
+            { "strata", resolution.strata }
+        };
 
-            bool maybe_unlocked = false;
-            Minisat::Var unlock = Minisat::var_Undef;
-            dap_map_t::iterator locked_dap = daps.end();
-            if (auto it = value.find("locked"); it != value.end()) {
-                locked_dap = daps.find(it->template get<std::string>());
-                if (locked_dap != daps.end()) {
-                    unlock = resolution.newVar();
-                }
+        auto &instances = stats["instances"] = nlohmann::json::array();
+        for (auto &report : reports) {
+            std::string status = "cancelled";
+            if (report.status == dappi::resolution_status::optimal) {
+                status = "optimal";
+            } else if (report.status == dappi::resolution_status::conflicted) {
+                status = "conflicted";
             }
+            instances.push_back({
+                { "settings", report.settings.describe() },
+                { "status", status },
+                { "winner", report.winner },
+                { "seconds", report.seconds },
+                { "solves", report.solves },
+                { "conflicts", report.conflicts },
+                { "decisions", report.decisions },
+                { "propagations", report.propagations }
+            });
+        }
 
-            auto known_it = value.find("known");
-            if (known_it != value.end()) {
-                auto &candidates = new_name.candidates;
-
-                std::multimap<
-                    semver::version,
-                    std::list<named_dap *>
-                > version_groups;
-
-                candidates.reserve(known_it->size());
-                for (auto &id_json : *known_it) {
-                    auto id = id_json.template get<std::string>();
-                    auto found_dap = daps.find(id);
-                    if (found_dap == daps.end()) {
-                        std::cerr << "ERROR: DAP " << id << " not defined."
-                                  << std::endl;
-                        return 1;
-                    } else {
-                        // Named DAP requires actual DAP instance.
-                        named_dap new_named_dap;
-                        new_named_dap.var = resolution.newVar();
-                        new_named_dap.referenced_dap = found_dap;
-                        resolution.addClause(
-                            ~Minisat::mkLit(new_named_dap.var),
-                            Minisat::mkLit(found_dap->second.var)
-                        );
-
-                        /*
-                         * Any selection other than the locked package is
-                         * counted as an unlock.
-                         */
-                        if (
-                            unlock != Minisat::var_Undef
-                            && found_dap != locked_dap
-                        ) {
-                            resolution.addClause(
-                                ~Minisat::mkLit(new_named_dap.var),
-                                Minisat::mkLit(unlock)
-                            );
-                            maybe_unlocked = true;
-                        }
-
-                        candidates.push_back(std::move(new_named_dap));
-
-                        auto &ver = found_dap->second.version;
-                        auto found = version_groups.find(ver);
-                        if (found == version_groups.end()) {
-                            found = version_groups.emplace(
-                                ver,
-                                std::list<named_dap *>()
-                            );
-                        }
-                        found->second.push_back(&candidates.back());
-                    }
-                }
-
-                // All named DAPs with same name are exclusive.
-                std::size_t num_candidates = candidates.size();
-                for (auto lhs = 0; lhs < num_candidates; ++lhs) {
-                    for (auto rhs = lhs + 1; rhs < num_candidates; ++rhs) {
-                        resolution.addClause(
-                            ~Minisat::mkLit(candidates[lhs].var),
-                            ~Minisat::mkLit(candidates[rhs].var)
-                        );
-                    }
-                }
-
-                std::vector<Minisat::Var> counters(version_groups.size());
-
-                /*
-                 * version_n_or_less_selected[n] implies counter[size - n]
-                 *   where 0 <= n < size
-                 *
-                 * Not selecting the package is best. Selecting the latest
-                 * version is second best, so we penalize one point.
-                 * Selecting earlier versions is worse than that, so we
-                 * penalize one point each time it is downgraded.
-                 */
-                std::size_t num_penalties = counters.size();
-                for (
-                    auto upper_bound = version_groups.begin();
-                    upper_bound != version_groups.end();
-                    ++upper_bound
-                ) {
-                    auto &counter = counters[--num_penalties];
-                    counter = resolution.newVar();
-
-                    /*
-                     * Given that version_n_or_less_selected[n] is:
-                     *   A or B or C,
-                     * (A or B or C) implies counter[n] is identical to
-                     * !(A or B or C) or counter[n], which is identical to
-                     * (!A and !B and !C) or counter[n].
-                     */
-                    auto end = std::next(upper_bound);
-                    for (auto it = version_groups.begin(); it != end; ++it) {
-                        for (auto candidate : it->second) {
-                            resolution.addClause(
-                                ~Minisat::mkLit(candidate->var),
-                                Minisat::mkLit(counter)
-                            );
-                        }
-                    }
-                }
-
-                penalty_groups.add(
-                    violation_counter_set(std::move(counters))
-                );
+        if (std::string_view(stats_output) == "-") {
+            std::cerr << stats.dump(2) << std::endl;
+        } else {
+            std::ofstream stats_file(stats_output, std::ios::binary);
+            if (!stats_file) {
+                std::cerr << "ERROR: Failed to open " << stats_output
+                          << " as output." << std::endl;
+                return 1;
             }
+            stats_file << stats.dump(2) << std::endl;
+        }
+    }
 
-            if (maybe_unlocked) {
-                unlocks.push_back(unlock);
-            }
+    if (!selections) {
+        std::cerr << "ERROR: No selection found." << std::endl;
+        return 1;
+    }
 
-            names.emplace(key, std::move(new_name));
+    bool workspace = state.contains("roots");
+    if (resolution.status == dappi::resolution_status::conflicted) {
+        std::cerr << "ERROR: Dependency conflicted";
+        if (workspace) {
+            std::cerr << " in "
+                      << problem->roots[selections->current_root()].id;
         }
+        std::cerr << "." << std::endl;
+        return 1;
+    } else if (resolution.status != dappi::resolution_status::optimal) {
+        /*
+         * The limits have run out before proving optimality, or the engine
+         * does not minimize the selections.
+         */
+        std::cout << "DAPPI_NONOPTIMAL()" << std::endl;
     }
 
-    if (daps_it != state.end()) {
-        for (auto &[key, value] : daps_it->items()) {
-            auto &this_dap = daps[key];
-            auto deps_it = value.find("dependencies");
-            if (deps_it != value.end()) {
-                for (auto &dep : *deps_it) {
-                    auto name_it = dep.find("name");
-                    if (name_it == dep.end()) {
-                        std::cerr << "ERROR: Invalid dependency." << std::endl;
-                        return 1;
-                    }
-                    std::string req = "*";
-                    auto req_it = dep.find("requiredVersion");
-                    if (req_it != dep.end()) {
-                        req = req_it->template get<std::string>();
-                    }
-                    auto name_str = name_it->template get<std::string>();
-                    auto found_name = names.find(name_str);
-                    if (found_name == names.end()) {
-                        std::cerr << "ERROR: name " << name_str << " not found"
-                                  << std::endl;
-                        return 1;
-                    }
-                    auto &candidates = found_name->second.candidates;
-                    auto new_var = resolution.newVar();
-                    resolution.addClause(
-                        ~Minisat::mkLit(this_dap.var),
-                        Minisat::mkLit(new_var)
-                    );
-                    Minisat::vec<Minisat::Lit> clause;
-                    clause.push(~Minisat::mkLit(new_var));
-                    for (auto &candidate : candidates) {
-                        auto &ver = candidate.referenced_dap->second.version;
-                        if (
-                            satisfies(
-                                ver,
-                                req,
-                                semver::range
-                                      ::satisfies_option
-                                      ::include_prerelease
-                            )
-                        ) {
-                            clause.push(Minisat::mkLit(candidate.var));
-                        }
-                    }
-                    if (clause.size() > 1) {
-                        resolution.addClause(clause);
-                    } else {
-                        std::cerr << "ERROR: No matching versions for package "
-                                  << name_str << " version " << req
-                                  << std::endl;
-                        return 1;
-                    }
-                }
+    /* Selections of a workspace follow the root they belong to. */
+    for (std::size_t root = 0; root < problem->roots.size(); ++root) {
+        if (workspace) {
+            std::cout << "DAPPI_ROOT(" << problem->roots[root].id << ")"
+                      << std::endl;
+        }
+        for (std::size_t index = 0; index < problem->names.size(); ++index) {
+            auto &key = problem->names[index].key;
+            auto selected_dap = selections->selection(root, index);
+            if (selected_dap) {
+                std::cout << "DAPPI_SELECT("
+                          << key
+                          << " "
+                          << problem->daps[*selected_dap].id
+                          << ")"
+                          << std::endl;
+            } else {
+                std::cout << "DAPPI_UNSELECT(" << key << ")" << std::endl;
             }
         }
     }
 
-    auto entry_it = state.find("entry");
-    if (entry_it != state.end()) {
-        auto id = entry_it->template get<std::string>();
-        auto found_dap = daps.find(id);
-        if (found_dap == daps.end()) {
-            std::cerr << "ERROR: DAP " << id << " not defined." << std::endl;
-            return 1;
-        } else {
-            resolution.addClause(Minisat::mkLit(found_dap->second.var));
-        }
+    for (auto dap_index : selections->frontier(frontier_size)) {
+        std::cout << "DAPPI_FRONTIER(" << problem->daps[dap_index].id << ")"
+                  << std::endl;
     }
 
-    auto save_selections = [&]() {
-        for (auto &name_pair : names) {
-            auto selected_dap = daps.end();
-            for (auto &candidate : name_pair.second.candidates) {
-                if (resolution.modelValue(candidate.var) == Minisat::l_True) {
-                    selected_dap = candidate.referenced_dap;
-                    break;
-                }
-            }
-            name_pair.second.selection = selected_dap;
+    return 0;
+}
+
+/* Reads "v1", "v1.2" or "v1.2.3" as a version, padding missing numbers. */
+std::optional<semver::version> tag_version(std::string_view tag) {
+    if (tag.empty() || tag.front() != 'v') {
+        return std::nullopt;
+    }
+    tag.remove_prefix(1);
+
+    std::string version_str;
+    int components = 0;
+    while (components < 3) {
+        auto dot = tag.find('.');
+        auto component = tag.substr(0, dot);
+        std::uint16_t number;
+        if (!parse_number(component, number)) {
+            return std::nullopt;
+        }
+        if (components > 0) {
+            version_str += '.';
         }
-    };
+        version_str += component;
+        ++components;
 
-    if (!resolution.solve()) {
-        std::cerr << "ERROR: Dependency conflicted." << std::endl;
-        return 1;
+        if (dot == std::string_view::npos) {
+            tag = std::string_view();
+            break;
+        }
+        tag.remove_prefix(dot + 1);
+    }
+    if (!tag.empty()) {
+        return std::nullopt;
+    }
+    for (; components < 3; ++components) {
+        version_str += ".0";
+    }
+
+    try {
+        return semver::version(version_str);
+    } catch (std::exception &) {
+        return std::nullopt;
     }
+}
+
+/*
+ * Prints the tags whose versions satisfy the range. Tags which cannot be read
+ * as versions are printed as well, since they cannot be ruled out.
+ */
+int match(int argc, char *argv[]) {
+    const char *range = nullptr;
+    std::vector<std::string_view> tags;
 
-    save_selections();
-
-    if (!unlocks.empty()) {
-        /* Now we minimize unlocks. */
-        auto unlock_counters =
-                make_general_violation_counters(resolution, unlocks);
-        auto last_assumption = Minisat::lit_Undef;
-        auto satisfiable = [&](std::nullptr_t, Minisat::Var var) {
-            auto assumption = ~Minisat::mkLit(var);
-            if (resolution.solve(assumption)) {
-                last_assumption = assumption;
-                save_selections();
-                return true;
+    int pos = 0;
+    while (pos < argc) {
+        std::string_view arg = argv[pos++];
+        if (arg == "-r") {
+            if (range) {
+                std::cerr << "ERROR: More than one -r are specified."
+                          << std::endl;
+                return 1;
+            } else if (pos == argc) {
+                std::cerr << "ERROR: -r requires subsequent argument."
+                          << std::endl;
+                return 1;
             } else {
-                return false;
+                range = argv[pos++];
             }
-        };
-        std::ignore = std::upper_bound(
-            unlock_counters.begin(),
-            unlock_counters.end(),
-            nullptr,
-            satisfiable
-        );
-        if (last_assumption != Minisat::lit_Undef) {
-            resolution.addClause(last_assumption);
+        } else {
+            tags.push_back(arg);
         }
     }
 
-    if (!penalty_groups.empty()) {
-        /* Now we improve the model */
-        penalty_groups.merge(resolution);
-        auto penalty_counters = penalty_groups.release();
-        auto satisfiable = [&](std::nullptr_t, Minisat::Var var) {
-            auto assumption = ~Minisat::mkLit(var);
-            if (resolution.solve(assumption)) {
-                save_selections();
-                return true;
-            } else {
-                return false;
-            }
-        };
-        std::ignore = std::upper_bound(
-            penalty_counters.begin(),
-            penalty_counters.end(),
-            nullptr,
-            satisfiable
-        );
+    if (!range) {
+        std::cerr << "ERROR: -r option is mandatory." << std::endl;
+        return 1;
     }
 
-    for (auto &name_pair : names) {
-        auto selected_dap = name_pair.second.selection;
-        if (selected_dap == daps.end()) {
-            std::cout << "DAPPI_UNSELECT(" << name_pair.first << ")"
-                      << std::endl;
-        } else {
-            std::cout << "DAPPI_SELECT("
-                      << name_pair.first
-                      << " "
-                      << selected_dap->first
-                      << ")"
-                      << std::endl;
+    for (auto tag : tags) {
+        auto version = tag_version(tag);
+        bool matched = true;
+        if (version) {
+            try {
+                matched = satisfies(
+                    *version,
+                    range,
+                    semver::range::satisfies_option::include_prerelease
+                );
+            } catch (std::exception &) {
+                std::cerr << "ERROR: Invalid range - " << range << std::endl;
+                return 1;
+            }
+        }
+        if (matched) {
+            std::cout << tag << std::endl;
         }
     }
 
@@ -1000,6 +1365,10 @@ int run(int, char *[]) {
 } // namespace
 
 int main(int argc, char *argv[]) {
+    if (auto code = dappi::forward_to_server(argc, argv); code) {
+        return *code;
+    }
+
     int pos = 1;
     int (*subcommand)(int, char *[]) = nullptr;
 
@@ -1011,6 +1380,12 @@ int main(int argc, char *argv[]) {
             subcommand = save;
         } else if (arg == "run") {
             subcommand = run;
+        } else if (arg == "match") {
+            subcommand = match;
+        } else if (arg == "index") {
+            subcommand = index_repositories;
+        } else if (arg == "serve") {
+            return dappi::serve(argc - pos, argv + pos, argv[0]);
         } else {
             std::cerr << "ERROR: Unrecognized argument - " << arg << std::endl;
             return 1;
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "portfolio.hpp"
+
+#include <chrono>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include "interrupt_timer.hpp"
+
+namespace dappi {
+
+std::vector<solver_settings> make_portfolio(std::size_t jobs) {
+    static const double decays[] = { 0.95, 0.9, 0.99, 0.85 };
+    static const int restarts[] = { 100, 50, 200, 400 };
+
+    std::vector<solver_settings> result(jobs);
+    for (std::size_t index = 1; index < jobs; ++index) {
+        auto &settings = result[index];
+        settings.random_seed = 91648253 + 7919 * index;
+        settings.random_var_freq = 0.02;
+        settings.var_decay = decays[index % std::size(decays)];
+        settings.restart_first = restarts[(index / 2) % std::size(restarts)];
+        settings.luby_restart = (index % 3 != 2);
+        settings.rnd_init_act = (index % 4 == 3);
+        settings.cardinality = (
+            index % 2 == 1
+            ? merge_order::sequential
+            : merge_order::smallest_first
+        );
+    }
+    return result;
+}
+
+std::unique_ptr<resolver> run_portfolio(
+    const resolution_problem &problem,
+    const std::vector<solver_settings> &portfolio,
+    const resolution_limits &limits,
+    std::vector<instance_report> &reports
+) {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<resolver>> instances(portfolio.size());
+    std::optional<std::size_t> winner;
+
+    /* This must be destroyed before the instances. */
+    std::optional<interrupt_timer> timer;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (limits.time) {
+        deadline = std::chrono::steady_clock::now() + *limits.time;
+        timer.emplace(*limits.time);
+    }
+
+    reports.assign(portfolio.size(), instance_report());
+
+    auto work = [&](std::size_t index) {
+        auto start = std::chrono::steady_clock::now();
+        auto &report = reports[index];
+        report.settings = portfolio[index];
+
+        auto instance = std::make_unique<resolver>(
+            problem,
+            portfolio[index]
+        );
+        if (limits.conflicts) {
+            instance->set_conflict_budget(*limits.conflicts);
+        }
+        if (deadline) {
+            instance->set_deadline(*deadline);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (winner) {
+                /* Someone has already won while we were encoding. */
+                report.seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start
+                ).count();
+                return;
+            }
+
+            /*
+             * Watched only once kept, since the timer interrupts its targets
+             * until it is destroyed after every thread has joined.
+             */
+            instances[index] = std::move(instance);
+            if (timer) {
+                timer->watch(*instances[index]);
+            }
+        }
+
+        auto &this_instance = *instances[index];
+        auto status = this_instance.resolve();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            report.status = status;
+            if (status != resolution_status::interrupted && !winner) {
+                winner = index;
+                for (auto &other : instances) {
+                    if (other && other.get() != &this_instance) {
+                        other->interrupt();
+                    }
+                }
+            }
+        }
+
+        auto &solver = this_instance.solver();
+        report.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        report.solves = solver.solves;
+        report.conflicts = solver.conflicts;
+        report.decisions = solver.decisions;
+        report.propagations = solver.propagations;
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(portfolio.size());
+    for (std::size_t index = 0; index < portfolio.size(); ++index) {
+        threads.emplace_back(work, index);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    timer.reset();
+
+    if (!winner) {
+        /* Every instance has run out of the limits. */
+        for (std::size_t index = 0; index < instances.size(); ++index) {
+            auto &instance = instances[index];
+            if (
+                instance
+                && instance->feasible()
+                && (!winner || instance->cost() < instances[*winner]->cost())
+            ) {
+                winner = index;
+            }
+        }
+    }
+
+    if (winner) {
+        reports[*winner].winner = true;
+        return std::move(instances[*winner]);
+    } else {
+        return nullptr;
+    }
+}
+
+} // namespace dappi
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef PORTFOLIO_HPP
+#define PORTFOLIO_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "resolution_problem.hpp"
+#include "resolver.hpp"
+
+namespace dappi {
+
+/*
+ * Returns settings for the given number of solver instances. The first
+ * instance always uses the default settings, so that a portfolio of one is
+ * identical to the plain resolution.
+ */
+std::vector<solver_settings> make_portfolio(std::size_t jobs);
+
+struct instance_report {
+    solver_settings settings;
+    std::optional<resolution_status> status;
+    bool winner = false;
+    double seconds = 0;
+    std::uint64_t solves = 0;
+    std::uint64_t conflicts = 0;
+    std::uint64_t decisions = 0;
+    std::uint64_t propagations = 0;
+};
+
+/*
+ * Runs one resolver per settings on separate threads. The first instance
+ * which finishes its resolution wins, and the others are interrupted. As
+ * every instance makes its optimal selections canonical, they do not depend
+ * on which one wins, except for the locks an update keeps, which follow the
+ * failed-assumption cores of the winner.
+ *
+ * If the limits interrupt all of them, the instance with the best selection
+ * found so far wins instead, as the limits leave every instance its first
+ * selections.
+ */
+std::unique_ptr<resolver> run_portfolio(
+    const resolution_problem &problem,
+    const std::vector<solver_settings> &portfolio,
+    const resolution_limits &limits,
+    std::vector<instance_report> &reports
+);
+
+} // namespace dappi
+
+#endif
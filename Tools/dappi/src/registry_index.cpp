@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "registry_index.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include "git_output.hpp"
+#include "sha512.hpp"
+
+namespace dappi {
+
+namespace {
+
+struct tag_entry {
+    std::string name;
+    std::string commit;
+};
+
+struct tree_entry {
+    std::string type;
+    std::string object;
+    std::string path;
+};
+
+/*
+ * Runs `git cat-file --batch` for the objects, and passes the content of
+ * each existing one to the consumer in chunks, with the index of the object.
+ */
+template <class Consumer>
+bool read_objects(
+    const std::string &git,
+    const std::string &git_dir,
+    const std::vector<std::string> &objects,
+    const std::string &scratch,
+    Consumer &&consumer
+) {
+    if (objects.empty()) {
+        return true;
+    }
+    if (!write_requests(scratch, objects)) {
+        std::cerr << "ERROR: Failed to write " << scratch << std::endl;
+        return false;
+    }
+    git_output output(git, git_dir, { "cat-file", "--batch" }, &scratch);
+    if (!output.is_open()) {
+        std::cerr << "ERROR: Failed to run " << output.command() << std::endl;
+        return false;
+    }
+    std::string header;
+    for (std::size_t index = 0; index < objects.size(); ++index) {
+        if (!output.read_until('\n', header)) {
+            std::cerr << "ERROR: Unexpected end of " << output.command()
+                      << std::endl;
+            return false;
+        }
+
+        /* "<object> <type> <size>" or "<object> missing" */
+        std::istringstream header_stream(header);
+        std::string object_id, type;
+        std::size_t size = 0;
+        if (!(header_stream >> object_id >> type >> size)) {
+            continue;
+        }
+        bool read = output.read_exactly(size, [&](std::string_view chunk) {
+            consumer(index, type, chunk);
+        });
+        if (!read || output.get() != '\n') {
+            std::cerr << "ERROR: Unexpected end of " << output.command()
+                      << std::endl;
+            return false;
+        }
+    }
+    if (!output.close()) {
+        std::cerr << "ERROR: " << output.command() << " failed." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool build_registry_index(
+    const std::string &git,
+    const std::vector<index_source> &sources,
+    const std::string &scratch,
+    YAML::Emitter &out
+) {
+    out << YAML::DoubleQuoted
+        << YAML::BeginMap
+        << YAML::Key << "version"
+        << YAML::Value << 1
+        << YAML::Key << "repositories"
+        << YAML::Value << YAML::BeginMap;
+
+    for (auto &source : sources) {
+        /* Annotated tags are peeled into the commits they point at. */
+        std::vector<tag_entry> tags;
+        {
+            git_output refs(
+                git,
+                source.git_dir,
+                {
+                    "for-each-ref",
+                    "--format=%(refname:strip=2) %(objectname) %(*objectname)",
+                    "refs/tags"
+                }
+            );
+            if (!refs.is_open()) {
+                std::cerr << "ERROR: Failed to run " << refs.command()
+                          << std::endl;
+                return false;
+            }
+            std::string line;
+            while (refs.read_until('\n', line)) {
+                std::istringstream line_stream(line);
+                tag_entry new_tag;
+                std::string object;
+                if (!(line_stream >> new_tag.name >> object)) {
+                    continue;
+                }
+                if (!(line_stream >> new_tag.commit)) {
+                    new_tag.commit = std::move(object);
+                }
+                tags.push_back(std::move(new_tag));
+            }
+            if (!refs.close()) {
+                std::cerr << "ERROR: " << refs.command() << " failed."
+                          << std::endl;
+                return false;
+            }
+        }
+
+        std::vector<std::string> awareness_objects;
+        for (auto &tag : tags) {
+            awareness_objects.push_back(
+                tag.commit + ":DependencyAwareness.yml"
+            );
+        }
+        std::vector<std::optional<std::string>> awareness(tags.size());
+        bool read = read_objects(
+            git,
+            source.git_dir,
+            awareness_objects,
+            scratch,
+            [&](std::size_t index, const std::string &type,
+                std::string_view chunk) {
+                if (type != "blob") {
+                    return;
+                }
+                if (!awareness[index]) {
+                    awareness[index].emplace();
+                }
+                awareness[index]->append(chunk);
+            }
+        );
+        if (!read) {
+            return false;
+        }
+
+        /* Each commit is listed once, and each blob is hashed once. */
+        std::map<std::string, std::vector<tree_entry>> trees;
+        std::vector<std::string> blobs;
+        std::map<std::string, std::size_t> blob_indices;
+        for (auto &tag : tags) {
+            if (trees.count(tag.commit)) {
+                continue;
+            }
+            auto &entries = trees[tag.commit];
+            git_output tree(
+                git,
+                source.git_dir,
+                { "ls-tree", "-r", "-z", tag.commit }
+            );
+            if (!tree.is_open()) {
+                std::cerr << "ERROR: Failed to run " << tree.command()
+                          << std::endl;
+                return false;
+            }
+
+            /* "<mode> <type> <object>\t<path>" */
+            std::string line;
+            while (tree.read_until('\0', line)) {
+                auto tab = line.find('\t');
+                std::istringstream line_stream(line.substr(0, tab));
+                std::string mode;
+                tree_entry entry;
+                if (
+                    tab == std::string::npos
+                    || !(line_stream >> mode >> entry.type >> entry.object)
+                ) {
+                    continue;
+                }
+                entry.path = line.substr(tab + 1);
+                if (
+                    entry.type == "blob"
+                    && blob_indices.emplace(entry.object, blobs.size()).second
+                ) {
+                    blobs.push_back(entry.object);
+                }
+                entries.push_back(std::move(entry));
+            }
+            if (!tree.close()) {
+                std::cerr << "ERROR: " << tree.command() << " failed."
+                          << std::endl;
+                return false;
+            }
+        }
+
+        std::vector<sha512> blob_hashes(blobs.size());
+        read = read_objects(
+            git,
+            source.git_dir,
+            blobs,
+            scratch,
+            [&](std::size_t index, const std::string &,
+                std::string_view chunk) {
+                blob_hashes[index].update(chunk);
+            }
+        );
+        if (!read) {
+            return false;
+        }
+        std::vector<std::string> blob_digests;
+        blob_digests.reserve(blobs.size());
+        for (auto &hash : blob_hashes) {
+            blob_digests.push_back(hash.hex_digest());
+        }
+
+        out << YAML::Key << source.path
+            << YAML::Value << YAML::BeginMap
+            << YAML::Key << "tags"
+            << YAML::Value << YAML::BeginMap;
+        for (std::size_t index = 0; index < tags.size(); ++index) {
+            auto &tag = tags[index];
+            out << YAML::Key << tag.name
+                << YAML::Value << YAML::BeginMap
+                << YAML::Key << "commit"
+                << YAML::Value << tag.commit;
+
+            /*
+             * Same as the digest calculated from a clone: SHA-512 of the list
+             * of digests and paths of the files. Submodules cannot be read
+             * from a clone, so such revisions are left without digests.
+             */
+            std::string hash_list;
+            bool hashable = true;
+            for (auto &entry : trees[tag.commit]) {
+                if (entry.type != "blob") {
+                    hashable = false;
+                    break;
+                }
+                hash_list += blob_digests[blob_indices.at(entry.object)];
+                hash_list += ' ';
+                hash_list += entry.path;
+                hash_list += '\n';
+            }
+            if (hashable) {
+                out << YAML::Key << "integrity"
+                    << YAML::Value << YAML::BeginMap
+                    << YAML::Key << "algorithm"
+                    << YAML::Value << "sha512"
+                    << YAML::Key << "digest"
+                    << YAML::Value << sha512_hex(hash_list)
+                    << YAML::EndMap;
+            }
+
+            if (awareness[index]) {
+                YAML::Node doc;
+                try {
+                    doc = YAML::Load(*awareness[index]);
+                } catch (std::exception &) {
+                    std::cerr << "WARNING: Failed to read YAML from "
+                              << source.path << "#" << tag.name
+                              << ":DependencyAwareness.yml" << std::endl;
+                }
+                if (doc) {
+                    out << YAML::Key << "awareness" << YAML::Value << doc;
+                }
+            }
+            out << YAML::EndMap;
+        }
+        out << YAML::EndMap << YAML::EndMap;
+    }
+
+    out << YAML::EndMap << YAML::EndMap << YAML::Newline;
+    return out.good();
+}
+
+} // namespace dappi
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef REGISTRY_INDEX_HPP
+#define REGISTRY_INDEX_HPP
+
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace dappi {
+
+/* A bare repository and the path of its location on the host */
+struct index_source {
+    std::string path;
+    std::string git_dir;
+};
+
+/*
+ * Reads every tag of the repositories with git, and writes the registry index
+ * of a host: the commit, the integrity digest and DependencyAwareness.yml of
+ * each tag. Digests are the ones dapper calculates for lockfiles. The scratch
+ * file is used for requests to git. Errors are reported to stderr.
+ */
+bool build_registry_index(
+    const std::string &git,
+    const std::vector<index_source> &sources,
+    const std::string &scratch,
+    YAML::Emitter &out
+);
+
+} // namespace dappi
+
+#endif
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "resolution_problem.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+
+namespace dappi {
+
+std::optional<resolution_problem> parse_resolution_problem(
+    const nlohmann::json &state
+) {
+    resolution_problem result;
+    std::unordered_map<std::string, std::size_t> dap_indices;
+    std::unordered_map<std::string, std::size_t> name_indices;
+
+    auto daps_it = state.find("daps");
+    if (daps_it != state.end()) {
+        result.daps.reserve(daps_it->size());
+        for (auto &[key, value] : daps_it->items()) {
+            problem_dap new_dap;
+            new_dap.id = key;
+
+            auto version_it = value.find("version");
+            if (version_it != value.end()) {
+                new_dap.version = semver::version(
+                    version_it->template get<std::string>()
+                );
+            }
+
+            auto unexplored_it = value.find("unexplored");
+            if (unexplored_it != value.end()) {
+                new_dap.unexplored = unexplored_it->template get<bool>();
+            }
+
+            dap_indices.emplace(key, result.daps.size());
+            result.daps.push_back(std::move(new_dap));
+        }
+    }
+
+    auto find_dap = [&](const std::string &id) {
+        auto found = dap_indices.find(id);
+        if (found == dap_indices.end()) {
+            return std::optional<std::size_t>();
+        } else {
+            return std::optional<std::size_t>(found->second);
+        }
+    };
+
+    /* Locks of the names, taken as the only root's unless "roots" is given */
+    std::vector<std::optional<std::size_t>> name_locks;
+
+    auto names_it = state.find("names");
+    if (names_it != state.end()) {
+        result.names.reserve(names_it->size());
+        for (auto &[key, value] : names_it->items()) {
+            problem_name new_name;
+            new_name.key = key;
+
+            auto selected_it = value.find("selected");
+            if (selected_it != value.end()) {
+                auto id = selected_it->template get<std::string>();
+                new_name.selected = find_dap(id);
+                if (!new_name.selected) {
+                    std::cerr << "ERROR: DAP " << id << " not defined."
+                              << std::endl;
+                    return std::nullopt;
+                }
+            }
+
+            if (auto it = value.find("priority"); it != value.end()) {
+                new_name.priority = it->template get<long long>();
+            }
+
+            /* A lock referring to an unknown DAP is simply ignored. */
+            auto &locked = name_locks.emplace_back();
+            if (auto it = value.find("locked"); it != value.end()) {
+                locked = find_dap(it->template get<std::string>());
+            }
+
+            auto known_it = value.find("known");
+            if (known_it != value.end()) {
+                new_name.candidates.reserve(known_it->size());
+                for (auto &id_json : *known_it) {
+                    auto id = id_json.template get<std::string>();
+                    auto found_dap = find_dap(id);
+                    if (found_dap) {
+                        new_name.candidates.push_back(*found_dap);
+                    } else {
+                        std::cerr << "ERROR: DAP " << id << " not defined."
+                                  << std::endl;
+                        return std::nullopt;
+                    }
+                }
+            }
+
+            name_indices.emplace(key, result.names.size());
+            result.names.push_back(std::move(new_name));
+        }
+    }
+
+    if (daps_it != state.end()) {
+        std::size_t dap_index = 0;
+        for (auto &[key, value] : daps_it->items()) {
+            auto &this_dap = result.daps[dap_index++];
+            auto deps_it = value.find("dependencies");
+            if (deps_it == value.end()) {
+                continue;
+            }
+
+            this_dap.dependencies.reserve(deps_it->size());
+            for (auto &dep : *deps_it) {
+                auto name_it = dep.find("name");
+                if (name_it == dep.end()) {
+                    std::cerr << "ERROR: Invalid dependency." << std::endl;
+                    return std::nullopt;
+                }
+                std::string req = "*";
+                auto req_it = dep.find("requiredVersion");
+                if (req_it != dep.end()) {
+                    req = req_it->template get<std::string>();
+                }
+                auto name_str = name_it->template get<std::string>();
+                auto found_name = name_indices.find(name_str);
+                if (found_name == name_indices.end()) {
+                    std::cerr << "ERROR: name " << name_str << " not found"
+                              << std::endl;
+                    return std::nullopt;
+                }
+
+                problem_dependency new_dep;
+                new_dep.name = found_name->second;
+                auto &candidates = result.names[new_dep.name].candidates;
+                for (std::size_t pos = 0; pos < candidates.size(); ++pos) {
+                    auto &ver = result.daps[candidates[pos]].version;
+                    if (
+                        satisfies(
+                            ver,
+                            req,
+                            semver::range
+                                  ::satisfies_option
+                                  ::include_prerelease
+                        )
+                    ) {
+                        new_dep.satisfying.push_back(pos);
+                    }
+                }
+                if (new_dep.satisfying.empty()) {
+                    std::cerr << "ERROR: No matching versions for package "
+                              << name_str << " version " << req
+                              << std::endl;
+                    return std::nullopt;
+                }
+                new_dep.required_version = std::move(req);
+                this_dap.dependencies.push_back(std::move(new_dep));
+            }
+        }
+    }
+
+    auto roots_it = state.find("roots");
+    if (roots_it == state.end()) {
+        auto &only_root = result.roots.emplace_back();
+        only_root.locked = std::move(name_locks);
+        auto entry_it = state.find("entry");
+        if (entry_it != state.end()) {
+            only_root.id = entry_it->template get<std::string>();
+            only_root.entry = find_dap(only_root.id);
+            if (!only_root.entry) {
+                std::cerr << "ERROR: DAP " << only_root.id << " not defined."
+                          << std::endl;
+                return std::nullopt;
+            }
+        }
+        return result;
+    }
+
+    result.roots.reserve(roots_it->size());
+    for (auto &[key, value] : roots_it->items()) {
+        auto &new_root = result.roots.emplace_back();
+        new_root.id = key;
+        new_root.entry = find_dap(key);
+        if (!new_root.entry) {
+            std::cerr << "ERROR: DAP " << key << " not defined." << std::endl;
+            return std::nullopt;
+        }
+
+        /* Locks of names no longer relevant are ignored as well. */
+        new_root.locked.resize(result.names.size());
+        auto locked_it = value.find("locked");
+        if (locked_it == value.end()) {
+            continue;
+        }
+        for (auto &[name, id_json] : locked_it->items()) {
+            auto found_name = name_indices.find(name);
+            if (found_name != name_indices.end()) {
+                new_root.locked[found_name->second] = find_dap(
+                    id_json.template get<std::string>()
+                );
+            }
+        }
+    }
+    if (result.roots.empty()) {
+        std::cerr << "ERROR: No roots are given." << std::endl;
+        return std::nullopt;
+    }
+
+    return result;
+}
+
+std::size_t reduce_symmetries(resolution_problem &problem) {
+    /* Dependencies each candidate satisfies, numbered in order of DAPs */
+    std::vector<std::vector<std::vector<std::size_t>>> satisfied(
+        problem.names.size()
+    );
+    for (std::size_t index = 0; index < problem.names.size(); ++index) {
+        satisfied[index].resize(problem.names[index].candidates.size());
+    }
+    std::size_t dependency_index = 0;
+    for (auto &this_dap : problem.daps) {
+        for (auto &dep : this_dap.dependencies) {
+            for (auto pos : dep.satisfying) {
+                satisfied[dep.name][pos].push_back(dependency_index);
+            }
+            ++dependency_index;
+        }
+    }
+
+    /* Roots locking each DAP */
+    std::vector<std::vector<std::size_t>> lockers(problem.daps.size());
+    for (std::size_t root = 0; root < problem.roots.size(); ++root) {
+        for (auto &locked : problem.roots[root].locked) {
+            if (locked) {
+                lockers[*locked].push_back(root);
+            }
+        }
+    }
+
+    using requirements =
+        std::vector<std::pair<std::size_t, std::vector<std::size_t>>>;
+    using signature = std::tuple<
+        std::vector<std::size_t>,
+        requirements,
+        std::vector<std::size_t>
+    >;
+
+    std::size_t num_dominated = 0;
+    for (std::size_t index = 0; index < problem.names.size(); ++index) {
+        auto &this_name = problem.names[index];
+        std::map<signature, std::size_t> newest;
+        for (std::size_t pos = 0; pos < this_name.candidates.size(); ++pos) {
+            auto dap_index = this_name.candidates[pos];
+            auto &this_dap = problem.daps[dap_index];
+
+            /* Partial dependencies tell nothing about the actual ones. */
+            if (this_dap.unexplored) {
+                continue;
+            }
+
+            requirements required;
+            required.reserve(this_dap.dependencies.size());
+            for (auto &dep : this_dap.dependencies) {
+                required.emplace_back(dep.name, dep.satisfying);
+            }
+            std::sort(required.begin(), required.end());
+
+            auto [it, inserted] = newest.emplace(
+                signature(
+                    lockers[dap_index],
+                    std::move(required),
+                    std::move(satisfied[index][pos])
+                ),
+                dap_index
+            );
+            if (inserted) {
+                continue;
+            }
+
+            /* The first one is kept among the same versions. */
+            auto &other_dap = problem.daps[it->second];
+            if (other_dap.version < this_dap.version) {
+                other_dap.dominated = true;
+                it->second = dap_index;
+            } else {
+                this_dap.dominated = true;
+            }
+            ++num_dominated;
+        }
+    }
+    return num_dominated;
+}
+
+std::size_t stratify(resolution_problem &problem) {
+    constexpr auto unreachable = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> depths(problem.names.size(), unreachable);
+    std::queue<std::size_t> queue;
+    auto reach = [&](const problem_dap &from, std::size_t depth) {
+        for (auto &dep : from.dependencies) {
+            if (depths[dep.name] == unreachable) {
+                depths[dep.name] = depth;
+                queue.push(dep.name);
+            }
+        }
+    };
+    for (auto &root : problem.roots) {
+        if (root.entry) {
+            reach(problem.daps[*root.entry], 1);
+        }
+    }
+    while (!queue.empty()) {
+        auto index = queue.front();
+        queue.pop();
+        for (auto dap_index : problem.names[index].candidates) {
+            reach(problem.daps[dap_index], depths[index] + 1);
+        }
+    }
+
+    using stratum_key = std::pair<long long, std::size_t>;
+    auto earlier = [](const stratum_key &lhs, const stratum_key &rhs) {
+        if (lhs.first != rhs.first) {
+            return (lhs.first > rhs.first);
+        }
+        return (lhs.second < rhs.second);
+    };
+    std::map<stratum_key, std::size_t, decltype(earlier)> strata(earlier);
+    for (std::size_t index = 0; index < problem.names.size(); ++index) {
+        strata.emplace(
+            stratum_key(problem.names[index].priority, depths[index]),
+            0
+        );
+    }
+    std::size_t num_strata = 0;
+    for (auto &[key, stratum] : strata) {
+        stratum = num_strata++;
+    }
+    for (std::size_t index = 0; index < problem.names.size(); ++index) {
+        auto &this_name = problem.names[index];
+        this_name.stratum = strata.at(
+            stratum_key(this_name.priority, depths[index])
+        );
+    }
+    return num_strata;
+}
+
+} // namespace dappi
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef RESOLUTION_PROBLEM_HPP
+#define RESOLUTION_PROBLEM_HPP
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <semver.hpp>
+
+namespace dappi {
+
+struct problem_dependency {
+    std::size_t name;
+    std::string required_version;
+
+    /* Indices into the candidates of the name which satisfy the range */
+    std::vector<std::size_t> satisfying;
+};
+
+struct problem_dap {
+    std::string id;
+    semver::version version;
+    std::vector<problem_dependency> dependencies;
+
+    /* Its declarations have not been walked, so dependencies are partial. */
+    bool unexplored = false;
+
+    /*
+     * Interchangeable with a newer candidate of its name, so the resolver
+     * never needs to select it. Set by reduce_symmetries().
+     */
+    bool dominated = false;
+};
+
+struct problem_name {
+    std::string key;
+    std::optional<std::size_t> selected;
+
+    /* Indices of DAPs known as this name */
+    std::vector<std::size_t> candidates;
+
+    /* Names of higher priorities are placed in earlier strata. */
+    long long priority = 0;
+
+    /*
+     * Penalties are minimized stratum by stratum, each one fixed before the
+     * next. Every name is in stratum 0 unless stratify() is called.
+     */
+    std::size_t stratum = 0;
+
+    /*
+     * Given to "run --update". If any name is, the locks of the others are
+     * kept unless they are proven to move along with it.
+     */
+    bool updating = false;
+};
+
+/*
+ * A project resolved on its own selection: the DAP standing for it, and the
+ * locks of its lockfile by index of names.
+ */
+struct problem_root {
+    std::string id;
+    std::optional<std::size_t> entry;
+    std::vector<std::optional<std::size_t>> locked;
+};
+
+/*
+ * The input of "run" mode, with every reference resolved into indices so
+ * that any number of solvers can be built from it without validating again.
+ *
+ * Without "roots" in the input, there is one root made of "entry" and the
+ * locks of the names. A workspace gives "roots" instead, which share every
+ * DAP and name.
+ */
+struct resolution_problem {
+    std::vector<problem_dap> daps;
+    std::vector<problem_name> names;
+    std::vector<problem_root> roots;
+};
+
+std::optional<resolution_problem> parse_resolution_problem(
+    const nlohmann::json &state
+);
+
+/*
+ * Marks the candidates which have the same dependencies as another candidate
+ * of the name, satisfy the same dependencies of the others and are locked by
+ * the same roots, except the newest one of each such class. Since they only
+ * differ in versions, the newest one is always preferred and the others can
+ * be left out of the search. Returns the number of candidates marked.
+ */
+std::size_t reduce_symmetries(resolution_problem &problem);
+
+/*
+ * Assigns strata to the names in the order of their priorities, then of
+ * their depths from the nearest entry, so that direct dependencies are
+ * optimized before transitive ones. Returns the number of strata.
+ */
+std::size_t stratify(resolution_problem &problem);
+
+} // namespace dappi
+
+#endif
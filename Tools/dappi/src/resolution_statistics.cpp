@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "resolution_statistics.hpp"
+
+namespace dappi {
+
+namespace {
+
+nlohmann::json phase_to_json(const phase_statistics &phase) {
+    return {
+        { "seconds", phase.seconds },
+        { "solves", phase.solves },
+        { "conflicts", phase.conflicts },
+        { "decisions", phase.decisions },
+        { "propagations", phase.propagations }
+    };
+}
+
+nlohmann::json encoding_to_json(const encoding_statistics &step) {
+    return {
+        { "vars", step.vars },
+        { "clauses", step.clauses }
+    };
+}
+
+} // namespace
+
+nlohmann::json resolution_statistics::to_json() const {
+    nlohmann::json result = {
+        {
+            "phases",
+            {
+                { "encoding", phase_to_json(encoding) },
+                { "firstSolve", phase_to_json(first_solve) },
+                {
+                    "unlockMinimization",
+                    phase_to_json(unlock_minimization)
+                },
+                {
+                    "penaltyMinimization",
+                    phase_to_json(penalty_minimization)
+                },
+                { "canonicalization", phase_to_json(canonicalization) }
+            }
+        },
+        {
+            "encoding",
+            {
+                { "daps", encoding_to_json(daps) },
+                { "candidates", encoding_to_json(candidates) },
+                { "exclusivity", encoding_to_json(exclusivity) },
+                { "penalties", encoding_to_json(penalties) },
+                { "dependencies", encoding_to_json(dependencies) },
+                { "unlockCounters", encoding_to_json(unlock_counters) },
+                { "penaltyMerges", encoding_to_json(penalty_merges) }
+            }
+        }
+    };
+    if (simplification) {
+        result["simplification"] = {
+            { "seconds", simplification->seconds },
+            { "frozenVars", simplification->frozen_vars },
+            { "eliminatedVars", simplification->eliminated_vars },
+            { "before", encoding_to_json(simplification->before) },
+            { "after", encoding_to_json(simplification->after) }
+        };
+    }
+    return result;
+}
+
+nlohmann::json version_solving_statistics::to_json() const {
+    return {
+        { "seconds", seconds },
+        { "decisions", decisions },
+        { "derivations", derivations },
+        { "conflicts", conflicts },
+        {
+            "incompatibilities",
+            {
+                { "requirements", requirements },
+                { "learned", learned }
+            }
+        }
+    };
+}
+
+} // namespace dappi
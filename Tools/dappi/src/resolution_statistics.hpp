@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef RESOLUTION_STATISTICS_HPP
+#define RESOLUTION_STATISTICS_HPP
+
+#include <cstdint>
+#include <optional>
+#include <nlohmann/json.hpp>
+
+namespace dappi {
+
+struct phase_statistics {
+    double seconds = 0;
+    std::uint64_t solves = 0;
+    std::uint64_t conflicts = 0;
+    std::uint64_t decisions = 0;
+    std::uint64_t propagations = 0;
+};
+
+/*
+ * Variables and clauses an encoding step has added to the solver. The
+ * clauses are a lower bound: MiniSat keeps no clause for a unit, a clause
+ * satisfied at level zero or a duplicate, so those are not counted.
+ */
+struct encoding_statistics {
+    std::uint64_t vars = 0;
+    std::uint64_t clauses = 0;
+};
+
+/* The reduction of the preprocessing run before the first solve */
+struct simplification_statistics {
+    double seconds = 0;
+    std::uint64_t frozen_vars = 0;
+    std::uint64_t eliminated_vars = 0;
+    encoding_statistics before;
+    encoding_statistics after;
+};
+
+struct resolution_statistics {
+    phase_statistics encoding;
+    phase_statistics first_solve;
+    phase_statistics unlock_minimization;
+    phase_statistics penalty_minimization;
+    phase_statistics canonicalization;
+
+    encoding_statistics daps;
+    encoding_statistics candidates;
+    encoding_statistics exclusivity;
+    encoding_statistics penalties;
+    encoding_statistics dependencies;
+    encoding_statistics unlock_counters;
+    encoding_statistics penalty_merges;
+
+    /* Present only if the solver has simplified the encoding. */
+    std::optional<simplification_statistics> simplification;
+
+    nlohmann::json to_json() const;
+};
+
+/* Counters of the search of version_solver over every root */
+struct version_solving_statistics {
+    double seconds = 0;
+    std::uint64_t decisions = 0;
+    std::uint64_t derivations = 0;
+    std::uint64_t conflicts = 0;
+
+    /* Incompatibilities given by requirements, and learned from conflicts */
+    std::uint64_t requirements = 0;
+    std::uint64_t learned = 0;
+
+    nlohmann::json to_json() const;
+};
+
+} // namespace dappi
+
+#endif
@@ -0,0 +1,724 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "resolver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include "general_violation_counters.hpp"
+
+namespace dappi {
+
+std::string solver_settings::describe() const {
+    std::ostringstream result;
+    result << "seed=" << static_cast<long long>(random_seed)
+           << " random-freq=" << random_var_freq
+           << " var-decay=" << var_decay
+           << " restarts=" << (luby_restart ? "luby" : "geometric")
+           << "/" << restart_first
+           << " init-act=" << (rnd_init_act ? "random" : "zero")
+           << " cardinality="
+           << (
+                  cardinality == merge_order::smallest_first
+                  ? "totalizer"
+                  : "sequential"
+              );
+    if (simplify) {
+        result << " simplify=on";
+    }
+    return result.str();
+}
+
+resolver::resolver(
+    const resolution_problem &problem,
+    const solver_settings &settings
+) : selection_set(problem),
+    M_cardinality(settings.cardinality) {
+    M_solver.random_seed = settings.random_seed;
+    M_solver.random_var_freq = settings.random_var_freq;
+    M_solver.var_decay = settings.var_decay;
+    M_solver.restart_first = settings.restart_first;
+    M_solver.luby_restart = settings.luby_restart;
+    M_solver.rnd_init_act = settings.rnd_init_act;
+
+    /* Without preprocessing, the solver behaves as the plain one. */
+    if (!settings.simplify) {
+        M_solver.eliminate(true);
+    }
+    encode();
+    if (settings.simplify) {
+        simplify();
+    }
+}
+
+namespace {
+
+class phase_scope {
+private:
+    const Minisat::Solver &M_solver;
+    phase_statistics &M_stats;
+    std::chrono::steady_clock::time_point M_start;
+    std::uint64_t M_solves;
+    std::uint64_t M_conflicts;
+    std::uint64_t M_decisions;
+    std::uint64_t M_propagations;
+
+public:
+    phase_scope(const Minisat::Solver &solver, phase_statistics &stats) :
+            M_solver(solver),
+            M_stats(stats),
+            M_start(std::chrono::steady_clock::now()),
+            M_solves(solver.solves),
+            M_conflicts(solver.conflicts),
+            M_decisions(solver.decisions),
+            M_propagations(solver.propagations) {
+    }
+
+    ~phase_scope() {
+        M_stats.seconds += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - M_start
+        ).count();
+        M_stats.solves += M_solver.solves - M_solves;
+        M_stats.conflicts += M_solver.conflicts - M_conflicts;
+        M_stats.decisions += M_solver.decisions - M_decisions;
+        M_stats.propagations += M_solver.propagations - M_propagations;
+    }
+};
+
+/* Adds the variables and clauses the solver has gained in the step. */
+template <class Step>
+void tally(
+    const Minisat::Solver &solver,
+    encoding_statistics &stats,
+    Step &&step
+) {
+    auto vars = solver.nVars();
+    auto clauses = solver.nClauses();
+    step();
+    stats.vars += solver.nVars() - vars;
+    stats.clauses += solver.nClauses() - clauses;
+}
+
+} // namespace
+
+/*
+ * Creates a variable which is read by modelValue(), assumed, or given more
+ * clauses after encoding, so that preprocessing never eliminates it.
+ */
+Minisat::Var resolver::new_interface_var() {
+    auto var = M_solver.newVar();
+    M_solver.setFrozen(var, true);
+    ++M_frozen_vars;
+    return var;
+}
+
+void resolver::encode() {
+    phase_scope phase(M_solver, M_statistics.encoding);
+
+    tally(M_solver, M_statistics.daps, [&]() {
+        M_dap_vars.reserve(M_problem.daps.size());
+        for (std::size_t index = 0; index < M_problem.daps.size(); ++index) {
+            M_dap_vars.push_back(M_solver.newVar());
+        }
+    });
+
+    std::size_t num_strata = 0;
+    for (auto &this_name : M_problem.names) {
+        num_strata = std::max(num_strata, this_name.stratum + 1);
+    }
+    M_penalty_strata.reserve(num_strata);
+    for (std::size_t index = 0; index < num_strata; ++index) {
+        M_penalty_strata.emplace_back(M_cardinality);
+    }
+
+    M_updating = std::any_of(
+        M_problem.names.begin(),
+        M_problem.names.end(),
+        [](auto &this_name) { return this_name.updating; }
+    );
+
+    M_roots.resize(M_problem.roots.size());
+    for (auto &root : M_roots) {
+        root.locks.resize(M_problem.names.size(), Minisat::var_Undef);
+    }
+
+    M_names.resize(M_problem.names.size());
+    for (std::size_t index = 0; index < M_problem.names.size(); ++index) {
+        auto &this_name = M_problem.names[index];
+        auto &candidates = M_names[index].candidates;
+
+        /* Each root locking the name counts its own unlock. */
+        struct lock_state {
+            std::size_t root;
+            std::size_t locked;
+            Minisat::Var unlock;
+            bool maybe_unlocked = false;
+        };
+        std::vector<lock_state> locks;
+        std::map<semver::version, std::vector<Minisat::Var>> version_groups;
+
+        tally(M_solver, M_statistics.candidates, [&]() {
+            for (std::size_t root = 0; root < M_roots.size(); ++root) {
+                auto &locked = M_problem.roots[root].locked[index];
+                if (locked) {
+                    auto unlock = new_interface_var();
+                    M_roots[root].locks[index] = unlock;
+                    locks.push_back({ root, *locked, unlock });
+                }
+            }
+
+            candidates.reserve(this_name.candidates.size());
+            for (auto dap_index : this_name.candidates) {
+                /*
+                 * A dominated candidate keeps its version counted in the
+                 * penalties, but is never selected.
+                 */
+                auto &this_dap = M_problem.daps[dap_index];
+                auto &group = version_groups[this_dap.version];
+                candidate new_candidate;
+                new_candidate.dap = dap_index;
+                if (this_dap.dominated) {
+                    candidates.push_back(new_candidate);
+                    continue;
+                }
+
+                // Named DAP requires actual DAP instance.
+                new_candidate.var = new_interface_var();
+                M_solver.addClause(
+                    ~Minisat::mkLit(new_candidate.var),
+                    Minisat::mkLit(M_dap_vars[dap_index])
+                );
+
+                /*
+                 * Any selection other than the locked package is counted as
+                 * an unlock. Unlocks of other roots are left free since
+                 * only the counters of the root being solved are bounded.
+                 */
+                for (auto &lock : locks) {
+                    if (dap_index != lock.locked) {
+                        M_solver.addClause(
+                            ~Minisat::mkLit(new_candidate.var),
+                            Minisat::mkLit(lock.unlock)
+                        );
+                        lock.maybe_unlocked = true;
+                    }
+                }
+
+                candidates.push_back(new_candidate);
+                group.push_back(new_candidate.var);
+            }
+        });
+
+        tally(M_solver, M_statistics.exclusivity, [&]() {
+            // All named DAPs with same name are exclusive.
+            std::vector<Minisat::Var> vars;
+            for (auto &this_candidate : candidates) {
+                if (this_candidate.var != Minisat::var_Undef) {
+                    vars.push_back(this_candidate.var);
+                }
+            }
+            for (std::size_t lhs = 0; lhs < vars.size(); ++lhs) {
+                for (auto rhs = lhs + 1; rhs < vars.size(); ++rhs) {
+                    M_solver.addClause(
+                        ~Minisat::mkLit(vars[lhs]),
+                        ~Minisat::mkLit(vars[rhs])
+                    );
+                }
+            }
+        });
+
+        if (!this_name.candidates.empty()) {
+            tally(M_solver, M_statistics.penalties, [&]() {
+                std::vector<Minisat::Var> counters(version_groups.size());
+
+                /*
+                 * version_n_or_less_selected[n] implies counter[size - n]
+                 *   where 0 <= n < size
+                 *
+                 * Not selecting the package is best. Selecting the latest
+                 * version is second best, so we penalize one point.
+                 * Selecting earlier versions is worse than that, so we
+                 * penalize one point each time it is downgraded.
+                 */
+                std::size_t num_penalties = counters.size();
+                for (
+                    auto upper_bound = version_groups.begin();
+                    upper_bound != version_groups.end();
+                    ++upper_bound
+                ) {
+                    auto &counter = counters[--num_penalties];
+                    counter = new_interface_var();
+
+                    /*
+                     * Given that version_n_or_less_selected[n] is:
+                     *   A or B or C,
+                     * (A or B or C) implies counter[n] is identical to
+                     * !(A or B or C) or counter[n], which is identical to
+                     * (!A and !B and !C) or counter[n].
+                     */
+                    auto end = std::next(upper_bound);
+                    for (auto it = version_groups.begin(); it != end; ++it) {
+                        for (auto var : it->second) {
+                            M_solver.addClause(
+                                ~Minisat::mkLit(var),
+                                Minisat::mkLit(counter)
+                            );
+                        }
+                    }
+                }
+
+                if (M_updating) {
+                    M_names[index].penalties = std::move(counters);
+                } else {
+                    M_penalty_strata[this_name.stratum].add(
+                        violation_counter_set(std::move(counters))
+                    );
+                }
+            });
+        }
+
+        for (auto &lock : locks) {
+            if (lock.maybe_unlocked) {
+                M_roots[lock.root].unlocks.push_back(lock.unlock);
+            }
+        }
+    }
+
+    tally(M_solver, M_statistics.dependencies, [&]() {
+        for (std::size_t index = 0; index < M_problem.daps.size(); ++index) {
+            if (M_problem.daps[index].dominated) {
+                continue;
+            }
+            auto this_var = M_dap_vars[index];
+            for (auto &dep : M_problem.daps[index].dependencies) {
+                auto &candidates = M_names[dep.name].candidates;
+                auto new_var = M_solver.newVar();
+                M_solver.addClause(
+                    ~Minisat::mkLit(this_var),
+                    Minisat::mkLit(new_var)
+                );
+                Minisat::vec<Minisat::Lit> clause;
+                clause.push(~Minisat::mkLit(new_var));
+                for (auto pos : dep.satisfying) {
+                    if (candidates[pos].var != Minisat::var_Undef) {
+                        clause.push(Minisat::mkLit(candidates[pos].var));
+                    }
+                }
+                M_solver.addClause(clause);
+            }
+        }
+
+        for (std::size_t index = 0; index < M_roots.size(); ++index) {
+            auto &entry = M_problem.roots[index].entry;
+            if (!entry) {
+                continue;
+            }
+            auto entry_lit = Minisat::mkLit(M_dap_vars[*entry]);
+            if (M_roots.size() == 1) {
+                M_solver.addClause(entry_lit);
+            } else {
+                auto &root_var = M_roots[index].var;
+                root_var = new_interface_var();
+                M_solver.addClause(~Minisat::mkLit(root_var), entry_lit);
+            }
+        }
+    });
+}
+
+/*
+ * Eliminates the variables only the encoding refers to, which are the DAPs
+ * and the dependencies, then turns elimination off so that the counters
+ * added later by optimization are kept as they are.
+ */
+void resolver::simplify() {
+    auto &stats = M_statistics.simplification.emplace();
+    auto start = std::chrono::steady_clock::now();
+    stats.frozen_vars = M_frozen_vars;
+    stats.before.vars = M_solver.nVars();
+    stats.before.clauses = M_solver.nClauses();
+    M_solver.eliminate(true);
+    stats.eliminated_vars = M_solver.eliminated_vars;
+    stats.after.vars = stats.before.vars - stats.eliminated_vars;
+    stats.after.clauses = M_solver.nClauses();
+    stats.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+}
+
+void resolver::save_selections() {
+    auto &selections = M_selections[M_root];
+    for (std::size_t index = 0; index < M_names.size(); ++index) {
+        auto &selection = selections[index];
+        selection.reset();
+        for (auto &candidate : M_names[index].candidates) {
+            if (
+                candidate.var != Minisat::var_Undef
+                && M_solver.modelValue(candidate.var) == Minisat::l_True
+            ) {
+                selection = candidate.dap;
+                break;
+            }
+        }
+    }
+}
+
+bool resolver::solve(Minisat::Lit assumption) {
+    Minisat::vec<Minisat::Lit> assumptions;
+    for (std::size_t root = 0; root < M_roots.size(); ++root) {
+        auto var = M_roots[root].var;
+        if (var != Minisat::var_Undef) {
+            assumptions.push(Minisat::mkLit(var, root != M_root));
+        }
+    }
+    for (auto pin : M_pins) {
+        assumptions.push(pin);
+    }
+    if (assumption != Minisat::lit_Undef) {
+        assumptions.push(assumption);
+    }
+    if (M_limited) {
+        if (
+            (M_conflict_limit && M_solver.conflicts >= *M_conflict_limit)
+            || (M_deadline && std::chrono::steady_clock::now() >= *M_deadline)
+        ) {
+            M_interrupted = true;
+            return false;
+        }
+        if (M_conflict_limit) {
+            M_solver.setConfBudget(*M_conflict_limit - M_solver.conflicts);
+        }
+    }
+    auto result = M_solver.solveLimited(assumptions);
+    while (result == Minisat::l_Undef && !M_limited && !M_cancelled) {
+        /* The deadline has come too late to stop the minimization. */
+        M_solver.clearInterrupt();
+        result = M_solver.solveLimited(assumptions);
+    }
+    if (result == Minisat::l_True) {
+        save_selections();
+        return true;
+    } else {
+        if (result == Minisat::l_Undef) {
+            M_interrupted = true;
+        }
+        return false;
+    }
+}
+
+/*
+ * Solves the current root keeping the locks of the names not updating as
+ * assumptions. Names whose locks are in the failed-assumption core are freed
+ * until a selection is found, and the locks left are fixed. Fails if the
+ * root conflicts with no locks to blame, or is interrupted.
+ */
+bool resolver::pin() {
+    auto &this_root = M_roots[M_root];
+    std::map<Minisat::Var, std::size_t> pinned_names;
+    this_root.pinned.assign(M_names.size(), false);
+    for (std::size_t index = 0; index < M_names.size(); ++index) {
+        auto unlock = this_root.locks[index];
+        if (
+            unlock != Minisat::var_Undef
+            && !M_problem.names[index].updating
+        ) {
+            pinned_names.emplace(unlock, index);
+            this_root.pinned[index] = true;
+        }
+    }
+
+    for (;;) {
+        M_pins.clear();
+        for (auto &[unlock, index] : pinned_names) {
+            M_pins.push_back(~Minisat::mkLit(unlock));
+        }
+        if (solve(Minisat::lit_Undef)) {
+            break;
+        } else if (M_interrupted) {
+            return false;
+        }
+
+        bool freed = false;
+        auto &core = M_solver.conflict;
+        for (int pos = 0; pos < core.size(); ++pos) {
+            auto found = pinned_names.find(Minisat::var(core[pos]));
+            if (found != pinned_names.end()) {
+                this_root.pinned[found->second] = false;
+                pinned_names.erase(found);
+                freed = true;
+            }
+        }
+        if (!freed) {
+            return false;
+        }
+    }
+    M_pins.clear();
+
+    /* Only the unlocks of the names freed by cores are minimized. */
+    this_root.unlocks.clear();
+    for (std::size_t index = 0; index < M_names.size(); ++index) {
+        auto unlock = this_root.locks[index];
+        if (unlock == Minisat::var_Undef) {
+            continue;
+        } else if (this_root.pinned[index]) {
+            fix(~Minisat::mkLit(unlock));
+        } else if (!M_problem.names[index].updating) {
+            this_root.unlocks.push_back(unlock);
+        }
+    }
+    return true;
+}
+
+/*
+ * Bounds the search of the current root from now on. The bound applies to
+ * the others as well if it is the only root.
+ */
+void resolver::fix(Minisat::Lit bound) {
+    auto root_var = M_roots[M_root].var;
+    if (root_var == Minisat::var_Undef) {
+        M_solver.addClause(bound);
+    } else {
+        M_solver.addClause(~Minisat::mkLit(root_var), bound);
+    }
+}
+
+/*
+ * Searches the least number of violations by binary search over the
+ * counters, and returns the assumption which bounds it. lit_Undef is
+ * returned if no counter can be negated.
+ */
+Minisat::Lit resolver::minimize(const violation_counter_set &counters) {
+    auto last_assumption = Minisat::lit_Undef;
+    auto satisfiable = [&](std::nullptr_t, Minisat::Var var) {
+        auto assumption = ~Minisat::mkLit(var);
+        if (!M_interrupted && solve(assumption)) {
+            last_assumption = assumption;
+            return true;
+        } else {
+            return false;
+        }
+    };
+    std::ignore = std::upper_bound(
+        counters.begin(),
+        counters.end(),
+        nullptr,
+        satisfiable
+    );
+    return last_assumption;
+}
+
+/*
+ * Returns the penalty counters of the stratum for the current root, or
+ * nullptr if it has no names to optimize. Counters of the strata are merged
+ * once and shared by the roots, while updates merge the names each root has
+ * freed.
+ */
+const violation_counter_set *resolver::penalty_counters(std::size_t stratum) {
+    auto &counters = M_penalty_counters[stratum];
+    if (!M_updating) {
+        auto &merger = M_penalty_strata[stratum];
+        if (!counters && !merger.empty()) {
+            tally(M_solver, M_statistics.penalty_merges, [&]() {
+                merger.merge(M_solver);
+            });
+            counters = merger.release();
+        }
+        return counters ? &*counters : nullptr;
+    }
+
+    auto &pinned = M_roots[M_root].pinned;
+    violation_counter_merger merger(M_cardinality);
+    for (std::size_t index = 0; index < M_names.size(); ++index) {
+        auto &penalties = M_names[index].penalties;
+        if (
+            !pinned[index]
+            && M_problem.names[index].stratum == stratum
+            && !penalties.empty()
+        ) {
+            merger.add(violation_counter_set(penalties));
+        }
+    }
+    if (merger.empty()) {
+        return nullptr;
+    }
+    tally(M_solver, M_statistics.penalty_merges, [&]() {
+        merger.merge(M_solver);
+    });
+    counters = merger.release();
+    return &*counters;
+}
+
+resolution_status resolver::resolve() {
+    {
+        phase_scope phase(M_solver, M_statistics.first_solve);
+        for (M_root = 0; M_root < M_roots.size(); ++M_root) {
+            if (M_updating ? pin() : solve(Minisat::lit_Undef)) {
+                continue;
+            } else if (M_interrupted) {
+                return resolution_status::interrupted;
+            } else {
+                return resolution_status::conflicted;
+            }
+        }
+    }
+    M_feasible = true;
+
+    /* The limits bound the minimization from now on. */
+    if (M_conflict_budget) {
+        M_conflict_limit = M_solver.conflicts + *M_conflict_budget;
+    }
+    M_limited = true;
+
+    for (M_root = 0; M_root < M_roots.size(); ++M_root) {
+        auto status = optimize();
+        if (status != resolution_status::optimal) {
+            return status;
+        }
+    }
+
+    M_limited = false;
+    phase_scope phase(M_solver, M_statistics.canonicalization);
+    if (!canonicalize()) {
+        return resolution_status::interrupted;
+    }
+    return resolution_status::optimal;
+}
+
+resolution_status resolver::optimize() {
+    auto &unlocks = M_roots[M_root].unlocks;
+    if (!unlocks.empty()) {
+        /* Now we minimize unlocks. */
+        phase_scope phase(M_solver, M_statistics.unlock_minimization);
+        std::optional<violation_counter_set> unlock_counters;
+        tally(M_solver, M_statistics.unlock_counters, [&]() {
+            unlock_counters = make_general_violation_counters(
+                M_solver,
+                unlocks,
+                M_cardinality
+            );
+        });
+        auto last_assumption = minimize(*unlock_counters);
+        if (M_interrupted) {
+            return resolution_status::interrupted;
+        }
+        if (last_assumption != Minisat::lit_Undef) {
+            fix(last_assumption);
+        }
+    }
+
+    M_penalty_counters.resize(M_penalty_strata.size());
+    for (std::size_t index = 0; index < M_penalty_strata.size(); ++index) {
+        /* Now we improve the model */
+        phase_scope phase(M_solver, M_statistics.penalty_minimization);
+        auto counters = penalty_counters(index);
+        if (!counters) {
+            continue;
+        }
+        auto last_assumption = minimize(*counters);
+        if (M_interrupted) {
+            return resolution_status::interrupted;
+        }
+
+        /* Later strata may not trade off what this one has reached. */
+        if (last_assumption != Minisat::lit_Undef) {
+            fix(last_assumption);
+        }
+    }
+
+    return resolution_status::optimal;
+}
+
+/*
+ * Settles every root on the first of its optimal selections in a fixed
+ * order, which depends on neither the settings nor the course of the
+ * search. Names are taken in the order of their keys, each left unselected
+ * if possible, and otherwise given the newest candidate possible, the first
+ * one known among the same versions. Returns false if interrupted.
+ */
+bool resolver::canonicalize() {
+    std::vector<std::size_t> names(M_names.size());
+    std::iota(names.begin(), names.end(), 0);
+    std::sort(names.begin(), names.end(), [&](auto lhs, auto rhs) {
+        return M_problem.names[lhs].key < M_problem.names[rhs].key;
+    });
+
+    M_solver.budgetOff();
+    for (M_root = 0; M_root < M_roots.size(); ++M_root) {
+        for (auto index : names) {
+            auto &candidates = M_names[index].candidates;
+            if (M_selections[M_root][index]) {
+                for (auto &this_candidate : candidates) {
+                    if (this_candidate.var != Minisat::var_Undef) {
+                        M_pins.push_back(~Minisat::mkLit(this_candidate.var));
+                    }
+                }
+                solve(Minisat::lit_Undef);
+                M_pins.clear();
+                if (M_interrupted) {
+                    return false;
+                }
+            }
+
+            auto selected = M_selections[M_root][index];
+            if (!selected) {
+                for (auto &this_candidate : candidates) {
+                    if (this_candidate.var != Minisat::var_Undef) {
+                        fix(~Minisat::mkLit(this_candidate.var));
+                    }
+                }
+                continue;
+            }
+
+            std::vector<const candidate *> newest_first;
+            for (auto &this_candidate : candidates) {
+                if (this_candidate.var != Minisat::var_Undef) {
+                    newest_first.push_back(&this_candidate);
+                }
+            }
+            std::stable_sort(
+                newest_first.begin(),
+                newest_first.end(),
+                [&](auto lhs, auto rhs) {
+                    return M_problem.daps[rhs->dap].version
+                        < M_problem.daps[lhs->dap].version;
+                }
+            );
+
+            /* The current selection is known to be possible. */
+            for (auto this_candidate : newest_first) {
+                auto lit = Minisat::mkLit(this_candidate->var);
+                if (this_candidate->dap == *selected || solve(lit)) {
+                    fix(lit);
+                    break;
+                } else if (M_interrupted) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace dappi
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef RESOLVER_HPP
+#define RESOLVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <minisat/simp/SimpSolver.h>
+#include "resolution_problem.hpp"
+#include "resolution_statistics.hpp"
+#include "selection_set.hpp"
+#include "violation_counter_merger.hpp"
+
+namespace dappi {
+
+/*
+ * Search parameters given to one solver instance. The defaults are the ones
+ * MiniSat ships with.
+ */
+struct solver_settings {
+    double random_seed = 91648253;
+    double random_var_freq = 0;
+    double var_decay = 0.95;
+    int restart_first = 100;
+    bool luby_restart = true;
+    bool rnd_init_act = false;
+    merge_order cardinality = merge_order::smallest_first;
+
+    /*
+     * Eliminates variables by SatELite preprocessing before the first
+     * solve, keeping the ones the resolver asks for after encoding.
+     */
+    bool simplify = false;
+
+    std::string describe() const;
+};
+
+/*
+ * Bounds of the optimization given by --conflict-budget and --time-limit.
+ * The first selection of every root is searched regardless of them, so they
+ * only cut the minimization short. The time counts from where it is given,
+ * including what is done before the search, like encoding, while the
+ * conflicts count from the start of the minimization.
+ */
+struct resolution_limits {
+    std::optional<std::uint64_t> conflicts;
+    std::optional<std::chrono::steady_clock::duration> time;
+};
+
+enum class resolution_status {
+    optimal,
+
+    /* Valid selections of an engine which does not minimize them */
+    feasible,
+
+    conflicted,
+    interrupted
+};
+
+/*
+ * Encodes a resolution problem into its own SAT solver and searches for the
+ * selection which keeps the locked packages and prefers higher versions.
+ */
+class resolver : public selection_set {
+private:
+    struct candidate {
+        /* var_Undef if the DAP is dominated */
+        Minisat::Var var = Minisat::var_Undef;
+        std::size_t dap;
+    };
+
+    struct name_state {
+        std::vector<candidate> candidates;
+
+        /* Counters of the penalty, kept apart from the strata by updates */
+        std::vector<Minisat::Var> penalties;
+    };
+
+    /*
+     * The entry of a root is required under its own literal, so that every
+     * root is solved on the same clauses. var_Undef if there is only one
+     * root, whose entry is required unconditionally.
+     */
+    struct root_state {
+        Minisat::Var var = Minisat::var_Undef;
+        std::vector<Minisat::Var> unlocks;
+
+        /* The unlock of each name locked by the root, by index of names */
+        std::vector<Minisat::Var> locks;
+
+        /* Names whose locks an update keeps, by index of names */
+        std::vector<bool> pinned;
+    };
+
+    merge_order M_cardinality;
+    Minisat::SimpSolver M_solver;
+    std::vector<Minisat::Var> M_dap_vars;
+    std::vector<name_state> M_names;
+    std::vector<root_state> M_roots;
+    std::vector<violation_counter_merger> M_penalty_strata;
+    std::vector<std::optional<violation_counter_set>> M_penalty_counters;
+    std::vector<Minisat::Lit> M_pins;
+    std::optional<std::uint64_t> M_conflict_budget;
+    std::optional<std::uint64_t> M_conflict_limit;
+    std::optional<std::chrono::steady_clock::time_point> M_deadline;
+
+    /* Whether the limits apply, which they do during the minimization */
+    std::atomic<bool> M_limited = false;
+    std::atomic<bool> M_cancelled = false;
+
+    std::size_t M_frozen_vars = 0;
+    bool M_updating = false;
+    bool M_interrupted = false;
+    bool M_feasible = false;
+    resolution_statistics M_statistics;
+
+    Minisat::Var new_interface_var();
+    void encode();
+    void simplify();
+    void save_selections();
+    bool solve(Minisat::Lit assumption);
+    bool pin();
+    void fix(Minisat::Lit bound);
+    Minisat::Lit minimize(const violation_counter_set &counters);
+    const violation_counter_set *penalty_counters(std::size_t stratum);
+    resolution_status optimize();
+    bool canonicalize();
+
+public:
+    resolver(
+        const resolution_problem &problem,
+        const solver_settings &settings
+    );
+
+    resolver(const resolver &) = delete;
+    resolver &operator =(const resolver &) = delete;
+
+    /*
+     * Limits the number of conflicts of the minimization. Once it runs out,
+     * the resolution is interrupted with the best selection found so far.
+     */
+    void set_conflict_budget(std::uint64_t budget) {
+        M_conflict_budget = budget;
+    }
+
+    /* Ends the minimization at the deadline like the conflict budget. */
+    void set_deadline(std::chrono::steady_clock::time_point deadline) {
+        M_deadline = deadline;
+    }
+
+    /*
+     * Finds a selection for every root first, then optimizes the roots one
+     * by one. Stops at the first root which is conflicted. The optimal
+     * selections are then made canonical, so that every instance ends up
+     * with the same ones whatever its settings.
+     *
+     * If names are updating, the other locks are kept as assumptions, and
+     * only the names of failed-assumption cores are freed along with them.
+     * Optimization is then restricted to the names not kept.
+     */
+    resolution_status resolve();
+
+    /* Whether every root has a selection, even if not optimal. */
+    bool feasible() const noexcept {
+        return M_feasible;
+    }
+
+    /* This is safe to be called from other threads. */
+    void interrupt() noexcept {
+        M_cancelled = true;
+        M_solver.interrupt();
+    }
+
+    /*
+     * Interrupts the search once the deadline has passed, which only takes
+     * effect during the minimization. This is safe to be called from other
+     * threads.
+     */
+    void expire() noexcept {
+        if (M_limited) {
+            M_solver.interrupt();
+        }
+    }
+
+    const Minisat::SimpSolver &solver() const noexcept {
+        return M_solver;
+    }
+
+    const resolution_statistics &statistics() const noexcept {
+        return M_statistics;
+    }
+};
+
+} // namespace dappi
+
+#endif
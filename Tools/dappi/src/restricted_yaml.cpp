@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "restricted_yaml.hpp"
+
+#include <algorithm>
+
+namespace dappi {
+
+namespace {
+
+constexpr auto npos = std::string_view::npos;
+
+bool is_sequence_entry(std::string_view content) {
+    return (
+        content.front() == '-'
+        && (content.size() == 1 || content[1] == ' ')
+    );
+}
+
+std::string_view skip_spaces(std::string_view text) {
+    auto begin = text.find_first_not_of(' ');
+    return (begin == npos ? std::string_view() : text.substr(begin));
+}
+
+/* Tells whether nothing but spaces and a comment are in the text. */
+bool is_blank(std::string_view text) {
+    text = skip_spaces(text);
+    return (text.empty() || text.front() == '#');
+}
+
+/* Plain scalars which yaml-cpp reads as null instead of strings */
+bool is_null(std::string_view plain) {
+    return (
+        plain == "~"
+        || plain == "null"
+        || plain == "Null"
+        || plain == "NULL"
+    );
+}
+
+/*
+ * Reads a scalar at the beginning of the text, removing it from the text. A
+ * key is followed by its colon, which is removed as well, and a value only
+ * by a comment.
+ */
+bool read_scalar(std::string_view &text, std::string_view &result, bool key) {
+    char first = text.front();
+    if (first == '"' || first == '\'') {
+        auto end = text.find(first, 1);
+        if (end == npos) {
+            /* It continues on the next line. */
+            return false;
+        }
+        result = text.substr(1, end - 1);
+        text.remove_prefix(end + 1);
+        bool escaped = (
+            first == '"'
+            ? result.find('\\') != npos
+            : !text.empty() && text.front() == '\''
+        );
+        if (escaped) {
+            return false;
+        }
+    } else {
+        if (std::string_view("[]{},#&*!|>%@`").find(first) != npos) {
+            return false;
+        }
+        if (
+            (first == '-' || first == '?' || first == ':')
+            && (text.size() == 1 || text[1] == ' ')
+        ) {
+            return false;
+        }
+
+        std::size_t end = 1;
+        for (; end < text.size(); ++end) {
+            if (
+                text[end] == ':'
+                && (end + 1 == text.size() || text[end + 1] == ' ')
+            ) {
+                break;
+            } else if (text[end] == '#' && text[end - 1] == ' ') {
+                break;
+            }
+        }
+        bool colon = (end < text.size() && text[end] == ':');
+        if (colon != key) {
+            return false;
+        }
+        result = text.substr(0, end);
+        result.remove_suffix(result.size() - result.find_last_not_of(' ') - 1);
+        if (is_null(result)) {
+            return false;
+        }
+        text.remove_prefix(end);
+    }
+
+    if (key) {
+        if (text.empty() || text.front() != ':') {
+            return false;
+        }
+        text.remove_prefix(1);
+        return (text.empty() || text.front() == ' ');
+    }
+    return is_blank(text);
+}
+
+} // namespace
+
+std::size_t restricted_yaml::add_child(
+    std::size_t parent,
+    std::size_t &last_child
+) {
+    std::size_t index = M_nodes.size();
+    M_nodes.emplace_back();
+    if (last_child == none) {
+        M_nodes[parent].first_child = index;
+    } else {
+        M_nodes[last_child].next_sibling = index;
+    }
+    last_child = index;
+    return index;
+}
+
+bool restricted_yaml::parse_block(std::size_t &pos, std::size_t index) {
+    auto &first_line = M_lines[pos];
+    if (is_sequence_entry(first_line.content)) {
+        return parse_sequence(pos, first_line.indent, index);
+    } else {
+        return parse_map(pos, first_line.indent, index);
+    }
+}
+
+bool restricted_yaml::parse_map(
+    std::size_t &pos,
+    std::size_t indent,
+    std::size_t index
+) {
+    M_nodes[index].type = node_type::map;
+    std::size_t last_child = none;
+    while (pos < M_lines.size() && M_lines[pos].indent == indent) {
+        auto content = M_lines[pos++].content;
+        std::string_view key;
+        if (is_sequence_entry(content) || !read_scalar(content, key, true)) {
+            return false;
+        }
+
+        auto child = add_child(index, last_child);
+        M_nodes[child].key = key;
+        if (!is_blank(content)) {
+            content = skip_spaces(content);
+            if (!read_scalar(content, M_nodes[child].value, false)) {
+                return false;
+            }
+        } else if (pos < M_lines.size() && M_lines[pos].indent > indent) {
+            if (!parse_block(pos, child)) {
+                return false;
+            }
+        } else if (
+            pos < M_lines.size()
+            && M_lines[pos].indent == indent
+            && is_sequence_entry(M_lines[pos].content)
+        ) {
+            /* A sequence may be as indented as the key it belongs to. */
+            if (!parse_sequence(pos, indent, child)) {
+                return false;
+            }
+        } else {
+            /* The value is null. */
+            return false;
+        }
+    }
+    return (pos == M_lines.size() || M_lines[pos].indent < indent);
+}
+
+bool restricted_yaml::parse_sequence(
+    std::size_t &pos,
+    std::size_t indent,
+    std::size_t index
+) {
+    M_nodes[index].type = node_type::sequence;
+    std::size_t last_child = none;
+    while (
+        pos < M_lines.size()
+        && M_lines[pos].indent == indent
+        && is_sequence_entry(M_lines[pos].content)
+    ) {
+        auto content = M_lines[pos++].content.substr(1);
+        auto child = add_child(index, last_child);
+        if (!is_blank(content)) {
+            content = skip_spaces(content);
+            if (!read_scalar(content, M_nodes[child].value, false)) {
+                return false;
+            }
+        } else if (pos < M_lines.size() && M_lines[pos].indent > indent) {
+            if (!parse_block(pos, child)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return (pos == M_lines.size() || M_lines[pos].indent <= indent);
+}
+
+bool restricted_yaml::parse(std::string_view text) {
+    M_lines.clear();
+    M_nodes.clear();
+
+    /* A byte order mark would be taken as a part of the first key. */
+    if (text.substr(0, 3) == "\xEF\xBB\xBF") {
+        return false;
+    }
+
+    M_lines.reserve(std::count(text.begin(), text.end(), '\n') + 1);
+    while (!text.empty()) {
+        auto end = text.find('\n');
+        auto content = text.substr(0, end);
+        text.remove_prefix(end == npos ? text.size() : end + 1);
+
+        if (!content.empty() && content.back() == '\r') {
+            content.remove_suffix(1);
+        }
+        auto indent = content.find_first_not_of(' ');
+        if (indent == npos) {
+            continue;
+        }
+        content.remove_prefix(indent);
+        if (content.front() == '#') {
+            continue;
+        }
+        if (content.find('\t') != npos) {
+            return false;
+        }
+        if (
+            indent == 0
+            && (
+                content.front() == '%'
+                || content.substr(0, 3) == "---"
+                || content.substr(0, 3) == "..."
+            )
+        ) {
+            /* Directives and documents markers */
+            return false;
+        }
+        M_lines.push_back({ indent, content });
+    }
+    if (M_lines.empty()) {
+        return false;
+    }
+
+    /* Every line makes one node at most. */
+    M_nodes.reserve(M_lines.size() + 1);
+    M_nodes.emplace_back();
+    std::size_t pos = 0;
+    return (parse_block(pos, 0) && pos == M_lines.size());
+}
+
+} // namespace dappi
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef RESTRICTED_YAML_HPP
+#define RESTRICTED_YAML_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace dappi {
+
+/*
+ * Parses the subset of YAML which DependencyAwareness.yml and lockfiles are
+ * usually written in: block mappings and sequences indented by spaces, whose
+ * scalars fit in a line and are plain, or quoted without escapes. Nodes refer
+ * into the text, so that reading a document allocates nothing but the nodes.
+ *
+ * Anything else, including null values, anchors, tags, flow collections and
+ * multi-line scalars, is outside the subset. Such documents are left to
+ * yaml-cpp, which knows the whole of YAML.
+ */
+class restricted_yaml {
+public:
+    static constexpr std::size_t none = static_cast<std::size_t>(-1);
+
+    enum class node_type {
+        scalar,
+        map,
+        sequence
+    };
+
+    struct node {
+        node_type type = node_type::scalar;
+
+        /* The key of an entry of a map */
+        std::string_view key;
+
+        /* The content of a scalar, without quotes */
+        std::string_view value;
+
+        std::size_t first_child = none;
+        std::size_t next_sibling = none;
+    };
+
+private:
+    struct line {
+        std::size_t indent;
+        std::string_view content;
+    };
+
+    std::vector<line> M_lines;
+    std::vector<node> M_nodes;
+
+    std::size_t add_child(std::size_t parent, std::size_t &last_child);
+    bool parse_block(std::size_t &pos, std::size_t index);
+    bool parse_map(std::size_t &pos, std::size_t indent, std::size_t index);
+    bool parse_sequence(
+        std::size_t &pos,
+        std::size_t indent,
+        std::size_t index
+    );
+
+public:
+    /*
+     * Returns false if the text is outside the subset, leaving the nodes
+     * unspecified. The text must outlive the nodes.
+     */
+    bool parse(std::string_view text);
+
+    const node &root() const noexcept {
+        return M_nodes.front();
+    }
+
+    const node &at(std::size_t index) const noexcept {
+        return M_nodes[index];
+    }
+};
+
+} // namespace dappi
+
+#endif
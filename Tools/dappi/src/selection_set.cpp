@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "selection_set.hpp"
+
+#include <algorithm>
+#include <set>
+
+namespace dappi {
+
+selection_set::selection_set(const resolution_problem &problem) :
+        M_problem(problem),
+        M_selections(
+            problem.roots.size(),
+            std::vector<std::optional<std::size_t>>(problem.names.size())
+        ) {
+}
+
+std::pair<std::size_t, std::vector<std::size_t>> selection_set::cost() const {
+    std::size_t num_strata = 0;
+    for (auto &this_name : M_problem.names) {
+        num_strata = std::max(num_strata, this_name.stratum + 1);
+    }
+
+    std::size_t unlocks = 0;
+    std::vector<std::size_t> penalties(num_strata);
+    for (std::size_t root = 0; root < M_selections.size(); ++root) {
+        auto &locks = M_problem.roots[root].locked;
+        auto &selections = M_selections[root];
+        for (std::size_t index = 0; index < selections.size(); ++index) {
+            auto &selection = selections[index];
+            if (!selection) {
+                continue;
+            }
+            if (locks[index] && *selection != *locks[index]) {
+                ++unlocks;
+            }
+
+            /* Same as the counters, one point for each newer version. */
+            auto &this_name = M_problem.names[index];
+            std::set<semver::version> newer_versions;
+            auto &selected_version = M_problem.daps[*selection].version;
+            for (auto dap_index : this_name.candidates) {
+                auto &version = M_problem.daps[dap_index].version;
+                if (selected_version <= version) {
+                    newer_versions.insert(version);
+                }
+            }
+            penalties[this_name.stratum] += newer_versions.size();
+        }
+    }
+    return std::make_pair(unlocks, std::move(penalties));
+}
+
+std::vector<std::size_t> selection_set::frontier(std::size_t size) const {
+    std::vector<std::size_t> result;
+    if (size == 0) {
+        return result;
+    }
+
+    /* Roots selecting the same name would report the same DAPs. */
+    std::set<std::size_t> reported;
+    for (std::size_t root = 0; root < M_selections.size(); ++root) {
+        auto &locks = M_problem.roots[root].locked;
+        auto &selections = M_selections[root];
+        for (std::size_t index = 0; index < selections.size(); ++index) {
+            auto &selection = selections[index];
+            if (!selection) {
+                continue;
+            }
+
+            auto &this_name = M_problem.names[index];
+            std::vector<std::size_t> plausible;
+            if (locks[index]) {
+                plausible.push_back(*locks[index]);
+            }
+            std::vector<std::size_t> newest = this_name.candidates;
+            std::stable_sort(
+                newest.begin(),
+                newest.end(),
+                [this](std::size_t lhs, std::size_t rhs) {
+                    return M_problem.daps[rhs].version
+                        < M_problem.daps[lhs].version;
+                }
+            );
+            plausible.insert(plausible.end(), newest.begin(), newest.end());
+
+            std::set<std::size_t> considered;
+            for (auto dap_index : plausible) {
+                if (considered.size() == size) {
+                    break;
+                } else if (!considered.insert(dap_index).second) {
+                    continue;
+                }
+                if (
+                    dap_index != *selection
+                    && M_problem.daps[dap_index].unexplored
+                    && reported.insert(dap_index).second
+                ) {
+                    result.push_back(dap_index);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace dappi
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef SELECTION_SET_HPP
+#define SELECTION_SET_HPP
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "resolution_problem.hpp"
+
+namespace dappi {
+
+/*
+ * The selections each root of a resolution problem has made, whichever
+ * engine has searched them, and what "run" derives from them.
+ */
+class selection_set {
+protected:
+    const resolution_problem &M_problem;
+
+    /* The DAP each root selects, by index of roots then of names */
+    std::vector<std::vector<std::optional<std::size_t>>> M_selections;
+
+    std::size_t M_root = 0;
+
+public:
+    explicit selection_set(const resolution_problem &problem);
+
+    /* Returns the index of the root at which the resolution has stopped. */
+    std::size_t current_root() const noexcept {
+        return M_root;
+    }
+
+    /*
+     * Returns the number of unlocks and the sums of version penalties of
+     * each stratum of the current selections, which are minimized in this
+     * order. Costs of the roots are summed.
+     */
+    std::pair<std::size_t, std::vector<std::size_t>> cost() const;
+
+    /*
+     * Returns the unexplored DAPs which the selections would plausibly
+     * switch to once their dependencies are known: the locked one and the
+     * newest ones of each selected name, up to the given number per name
+     * and root.
+     */
+    std::vector<std::size_t> frontier(std::size_t size) const;
+
+    /* Returns the index of the DAP the root selects for the name, if any. */
+    std::optional<std::size_t> selection(
+        std::size_t root,
+        std::size_t name
+    ) const {
+        return M_selections[root][name];
+    }
+};
+
+} // namespace dappi
+
+#endif
@@ -0,0 +1,748 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "server.hpp"
+
+#include <iostream>
+
+#ifdef _WIN32
+
+namespace dappi {
+
+int serve(int, char *[], const char *) {
+    std::cerr << "ERROR: serve is not supported on this platform."
+              << std::endl;
+    return 1;
+}
+
+std::optional<int> forward_to_server(int, char *[]) {
+    return std::nullopt;
+}
+
+} // namespace dappi
+
+#else
+
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "sha512.hpp"
+
+namespace dappi {
+
+namespace {
+
+/* Changed whenever requests or responses change. */
+constexpr std::string_view protocol = "dappi-serve-1";
+
+bool write_all(int fd, const char *data, std::size_t size) {
+    while (size > 0) {
+        auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool read_all(int fd, char *data, std::size_t size) {
+    while (size > 0) {
+        auto count = ::read(fd, data, size);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        } else if (count == 0) {
+            return false;
+        }
+        data += count;
+        size -= static_cast<std::size_t>(count);
+    }
+    return true;
+}
+
+bool write_number(int fd, std::uint64_t value) {
+    auto *data = reinterpret_cast<const char *>(&value);
+    return write_all(fd, data, sizeof(value));
+}
+
+bool read_number(int fd, std::uint64_t &value) {
+    return read_all(fd, reinterpret_cast<char *>(&value), sizeof(value));
+}
+
+bool write_string(int fd, std::string_view value) {
+    return (
+        write_number(fd, value.size())
+        && write_all(fd, value.data(), value.size())
+    );
+}
+
+bool read_string(int fd, std::string &value) {
+    std::uint64_t size;
+    if (!read_number(fd, size) || size > std::uint64_t(1) << 32) {
+        return false;
+    }
+    value.resize(static_cast<std::size_t>(size));
+    return read_all(fd, value.data(), value.size());
+}
+
+bool make_address(const char *path, sockaddr_un &address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::strcpy(address.sun_path, path);
+    return true;
+}
+
+int connect_socket(const char *path) {
+    sockaddr_un address;
+    if (!make_address(path, address)) {
+        return -1;
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    auto *generic_address = reinterpret_cast<sockaddr *>(&address);
+    if (::connect(fd, generic_address, sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct command_result {
+    std::string out;
+    std::string err;
+    int code = 1;
+};
+
+/*
+ * Descriptors are made and marked close-on-exec under this lock, so that no
+ * child spawned meanwhile inherits the pipes of another one. Otherwise the
+ * output of a command would not end until the other child exits.
+ */
+std::mutex spawn_mutex;
+
+bool make_pipe(int fds[2]) {
+    if (::pipe(fds) != 0) {
+        return false;
+    }
+    ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+}
+
+/* Runs dappi with the arguments, passing the input and taking its output. */
+std::optional<command_result> run_command(
+    const std::string &executable,
+    const std::string &cwd,
+    const std::vector<std::string> &args,
+    const std::string &input
+) {
+    /* Nothing may be allocated after fork. */
+    std::vector<char *> child_argv;
+    child_argv.push_back(const_cast<char *>(executable.c_str()));
+    for (auto &arg : args) {
+        child_argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    child_argv.push_back(nullptr);
+
+    int in[2];
+    int out[2];
+    int err[2];
+    pid_t pid;
+    {
+        std::lock_guard<std::mutex> lock(spawn_mutex);
+        if (!make_pipe(in)) {
+            return std::nullopt;
+        } else if (!make_pipe(out)) {
+            ::close(in[0]);
+            ::close(in[1]);
+            return std::nullopt;
+        } else if (!make_pipe(err)) {
+            ::close(in[0]);
+            ::close(in[1]);
+            ::close(out[0]);
+            ::close(out[1]);
+            return std::nullopt;
+        }
+
+        pid = ::fork();
+        if (pid == 0) {
+            if (
+                ::chdir(cwd.c_str()) == 0
+                && ::dup2(in[0], 0) >= 0
+                && ::dup2(out[1], 1) >= 0
+                && ::dup2(err[1], 2) >= 0
+            ) {
+                ::execvp(child_argv[0], child_argv.data());
+            }
+            ::_exit(127);
+        }
+    }
+    ::close(in[0]);
+    ::close(out[1]);
+    ::close(err[1]);
+    if (pid < 0) {
+        ::close(in[1]);
+        ::close(out[0]);
+        ::close(err[0]);
+        return std::nullopt;
+    }
+
+    command_result result;
+    int in_fd = in[1];
+    std::size_t written = 0;
+    if (input.empty()) {
+        ::close(in_fd);
+        in_fd = -1;
+    } else {
+        ::fcntl(in_fd, F_SETFL, O_NONBLOCK);
+    }
+    int out_fd = out[0];
+    int err_fd = err[0];
+    char buffer[65536];
+    while (out_fd >= 0 || err_fd >= 0) {
+        pollfd fds[3];
+        nfds_t num_fds = 0;
+        for (int fd : { in_fd, out_fd, err_fd }) {
+            if (fd >= 0) {
+                fds[num_fds++] = {
+                    fd,
+                    static_cast<short>(fd == in_fd ? POLLOUT : POLLIN),
+                    0
+                };
+            }
+        }
+        if (::poll(fds, num_fds, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (nfds_t index = 0; index < num_fds; ++index) {
+            auto &entry = fds[index];
+            if (entry.revents == 0) {
+                continue;
+            } else if (entry.fd == in_fd) {
+                auto count = ::write(
+                    in_fd,
+                    input.data() + written,
+                    input.size() - written
+                );
+                if (count > 0) {
+                    written += static_cast<std::size_t>(count);
+                }
+                if (
+                    written == input.size()
+                    || (count < 0 && errno != EAGAIN && errno != EINTR)
+                ) {
+                    ::close(in_fd);
+                    in_fd = -1;
+                }
+            } else {
+                auto count = ::read(entry.fd, buffer, sizeof(buffer));
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                auto &output = (entry.fd == out_fd ? result.out : result.err);
+                if (count > 0) {
+                    output.append(buffer, static_cast<std::size_t>(count));
+                } else {
+                    ::close(entry.fd);
+                    (entry.fd == out_fd ? out_fd : err_fd) = -1;
+                }
+            }
+        }
+    }
+    for (int fd : { in_fd, out_fd, err_fd }) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    result.code = (WIFEXITED(status) ? WEXITSTATUS(status) : 1);
+    return result;
+}
+
+/*
+ * Results of commands by their keys, evicting the least recently used ones
+ * beyond the capacity in bytes.
+ */
+class result_cache {
+private:
+    struct entry {
+        command_result result;
+        std::list<std::string>::iterator order;
+    };
+
+    std::mutex M_mutex;
+    std::list<std::string> M_order;
+    std::unordered_map<std::string, entry> M_entries;
+    std::size_t M_size = 0;
+    std::size_t M_capacity;
+
+    static std::size_t size_of(
+        const std::string &key,
+        const command_result &result
+    ) noexcept {
+        return key.size() + result.out.size() + result.err.size();
+    }
+
+public:
+    explicit result_cache(std::size_t capacity) noexcept
+        : M_capacity(capacity) {
+    }
+
+    std::optional<command_result> find(const std::string &key) {
+        std::lock_guard<std::mutex> lock(M_mutex);
+        auto found = M_entries.find(key);
+        if (found == M_entries.end()) {
+            return std::nullopt;
+        }
+        M_order.splice(M_order.begin(), M_order, found->second.order);
+        return found->second.result;
+    }
+
+    void insert(const std::string &key, const command_result &result) {
+        auto size = size_of(key, result);
+        std::lock_guard<std::mutex> lock(M_mutex);
+        if (size > M_capacity || M_entries.count(key) > 0) {
+            return;
+        }
+        M_order.push_front(key);
+        M_entries.emplace(key, entry{ result, M_order.begin() });
+        M_size += size;
+        while (M_size > M_capacity) {
+            auto last = M_entries.find(M_order.back());
+            M_size -= size_of(last->first, last->second.result);
+            M_entries.erase(last);
+            M_order.pop_back();
+        }
+    }
+};
+
+/*
+ * Returns the key of the command, or nullopt if it cannot be cached. Files
+ * given to load are keyed by their contents rather than their paths, since
+ * the driver writes them with temporary names. Statistics describe the run
+ * which has produced them, so commands writing them are not cached. Neither
+ * are loads of da-repos, which read revisions given by tag or branch names
+ * from repositories that later fetches update.
+ */
+std::optional<std::string> cache_key(
+    const std::string &cwd,
+    const std::vector<std::string> &args,
+    const std::string &input
+) {
+    sha512 hash;
+    auto add = [&](std::string_view part) {
+        hash.update(std::to_string(part.size()));
+        hash.update(":");
+        hash.update(part);
+    };
+    add(protocol);
+    for (std::size_t index = 0; index < args.size(); ++index) {
+        if (
+            args[index] == "--stats"
+            || (
+                args[0] == "load"
+                && args[index] == "-t"
+                && index + 1 < args.size()
+                && args[index + 1] == "da-repos"
+            )
+        ) {
+            return std::nullopt;
+        }
+        add(args[index]);
+        if (
+            args[0] == "load"
+            && (args[index] == "-i" || args[index] == "--requests")
+            && index + 1 < args.size()
+        ) {
+            auto &path = args[++index];
+            std::ifstream file(
+                (path.front() == '/' ? path : cwd + '/' + path),
+                std::ios::binary
+            );
+            if (!file) {
+                return std::nullopt;
+            }
+            add(std::string(std::istreambuf_iterator<char>(file), {}));
+        }
+    }
+    add(input);
+    return hash.hex_digest();
+}
+
+struct server_state {
+    std::string executable;
+    result_cache cache;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::size_t active = 0;
+    std::chrono::steady_clock::time_point last_request;
+
+    server_state(std::string executable, std::size_t cache_size)
+        : executable(std::move(executable)),
+          cache(cache_size),
+          last_request(std::chrono::steady_clock::now()) {
+    }
+};
+
+/* Answers one client, which gives its command and its input. */
+void handle_client(int fd, server_state &state) {
+    std::string version;
+    std::string cwd;
+    std::uint64_t num_args = 0;
+    std::vector<std::string> args;
+    std::string input;
+    bool valid = (
+        read_string(fd, version)
+        && version == protocol
+        && read_string(fd, cwd)
+        && read_number(fd, num_args)
+        && num_args > 0
+        && num_args < 4096
+    );
+    for (std::uint64_t index = 0; valid && index < num_args; ++index) {
+        valid = read_string(fd, args.emplace_back());
+    }
+    valid = valid && read_string(fd, input);
+
+    if (valid) {
+        auto key = cache_key(cwd, args, input);
+        std::optional<command_result> result;
+        if (key) {
+            result = state.cache.find(*key);
+        }
+        if (!result) {
+            result = run_command(state.executable, cwd, args, input);
+
+            /* A selection not proven optimal may improve on the next run. */
+            if (
+                result
+                && key
+                && result->code == 0
+                && result->out.find("DAPPI_NONOPTIMAL") == std::string::npos
+            ) {
+                state.cache.insert(*key, *result);
+            }
+        }
+
+        /* Without a response, the client runs the command by itself. */
+        if (result) {
+            write_string(fd, result->out)
+                && write_string(fd, result->err)
+                && write_number(fd, static_cast<std::uint64_t>(result->code));
+        }
+    }
+    ::close(fd);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    --state.active;
+    state.last_request = std::chrono::steady_clock::now();
+    state.finished.notify_all();
+}
+
+volatile std::sig_atomic_t stopping = 0;
+
+void stop(int) {
+    stopping = 1;
+}
+
+std::string resolve_executable(const char *argv0) {
+    char buffer[PATH_MAX];
+    auto size = ::readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+    if (size > 0) {
+        return std::string(buffer, static_cast<std::size_t>(size));
+    }
+    if (std::strchr(argv0, '/')) {
+        if (char *path = ::realpath(argv0, nullptr); path) {
+            std::string result = path;
+            std::free(path);
+            return result;
+        }
+    }
+
+    /* Found in PATH again by execvp() */
+    return argv0;
+}
+
+template <class T>
+bool parse_number(std::string_view str, T &value) {
+    auto [end, error] = std::from_chars(
+        str.data(),
+        str.data() + str.size(),
+        value
+    );
+    return (error == std::errc() && end == str.data() + str.size());
+}
+
+} // namespace
+
+int serve(int argc, char *argv[], const char *executable) {
+    const char *socket_path = nullptr;
+    std::uint64_t idle_timeout = 0;
+    std::size_t cache_size = 256;
+
+    int pos = 0;
+    while (pos < argc) {
+        std::string_view arg = argv[pos++];
+        if (arg == "--socket") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --socket requires subsequent argument."
+                          << std::endl;
+                return 1;
+            }
+            socket_path = argv[pos++];
+        } else if (arg == "--idle-timeout") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --idle-timeout requires subsequent "
+                          << "argument." << std::endl;
+                return 1;
+            }
+            std::string_view timeout_str = argv[pos++];
+            if (!parse_number(timeout_str, idle_timeout)) {
+                std::cerr << "ERROR: Invalid idle timeout - " << timeout_str
+                          << std::endl;
+                return 1;
+            }
+        } else if (arg == "--cache-size") {
+            if (pos == argc) {
+                std::cerr << "ERROR: --cache-size requires subsequent "
+                          << "argument." << std::endl;
+                return 1;
+            }
+            std::string_view size_str = argv[pos++];
+            if (!parse_number(size_str, cache_size)) {
+                std::cerr << "ERROR: Invalid cache size - " << size_str
+                          << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "ERROR: Unrecognized argument - " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (!socket_path) {
+        std::cerr << "ERROR: --socket option is mandatory." << std::endl;
+        return 1;
+    }
+
+    sockaddr_un address;
+    if (!make_address(socket_path, address)) {
+        std::cerr << "ERROR: Socket path is too long - " << socket_path
+                  << std::endl;
+        return 1;
+    }
+
+    /* A socket left by a server which has exited is replaced. */
+    if (int fd = connect_socket(socket_path); fd >= 0) {
+        ::close(fd);
+        std::cerr << "ERROR: A server is already listening on "
+                  << socket_path << std::endl;
+        return 1;
+    }
+    ::unlink(socket_path);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    auto *generic_address = reinterpret_cast<sockaddr *>(&address);
+    if (
+        listener < 0
+        || ::bind(listener, generic_address, sizeof(address)) != 0
+        || ::listen(listener, SOMAXCONN) != 0
+    ) {
+        std::cerr << "ERROR: Failed to listen on " << socket_path
+                  << std::endl;
+        if (listener >= 0) {
+            ::close(listener);
+        }
+        return 1;
+    }
+    ::fcntl(listener, F_SETFD, FD_CLOEXEC);
+
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    /* Commands run by the server must not come back to it. */
+    ::unsetenv("DAPPI_SOCKET");
+
+    server_state state(resolve_executable(executable), cache_size << 20);
+    std::cerr << "INFO: Listening on " << socket_path << std::endl;
+
+    while (!stopping) {
+        pollfd entry = { listener, POLLIN, 0 };
+        int ready = ::poll(&entry, 1, 1000);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        } else if (ready > 0) {
+            int client;
+            {
+                std::lock_guard<std::mutex> lock(spawn_mutex);
+                client = ::accept(listener, nullptr, nullptr);
+                if (client >= 0) {
+                    ::fcntl(client, F_SETFD, FD_CLOEXEC);
+                }
+            }
+            if (client >= 0) {
+                {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    ++state.active;
+                }
+                std::thread(handle_client, client, std::ref(state)).detach();
+            }
+        } else if (idle_timeout > 0) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            auto idle = std::chrono::steady_clock::now() - state.last_request;
+            if (
+                state.active == 0
+                && idle >= std::chrono::seconds(idle_timeout)
+            ) {
+                break;
+            }
+        }
+    }
+
+    ::close(listener);
+    ::unlink(socket_path);
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.finished.wait(lock, [&] { return state.active == 0; });
+    return 0;
+}
+
+std::optional<int> forward_to_server(int argc, char *argv[]) {
+    const char *socket_path = std::getenv("DAPPI_SOCKET");
+    if (!socket_path || !*socket_path || argc < 2) {
+        return std::nullopt;
+    }
+
+    /* Commands writing files are run here. */
+    std::string_view command = argv[1];
+    bool reads_input = false;
+    if (command == "run") {
+        reads_input = true;
+        for (int pos = 2; pos + 1 < argc; ++pos) {
+            if (
+                std::string_view(argv[pos]) == "--stats"
+                && std::string_view(argv[pos + 1]) != "-"
+            ) {
+                return std::nullopt;
+            }
+        }
+    } else if (command != "load" && command != "match") {
+        return std::nullopt;
+    }
+
+    char cwd[PATH_MAX];
+    if (!::getcwd(cwd, sizeof(cwd))) {
+        return std::nullopt;
+    }
+    int fd = connect_socket(socket_path);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::string input;
+    if (reads_input) {
+        input.assign(std::istreambuf_iterator<char>(std::cin), {});
+    }
+    bool sent = (
+        write_string(fd, protocol)
+        && write_string(fd, cwd)
+        && write_number(fd, static_cast<std::uint64_t>(argc - 1))
+    );
+    for (int pos = 1; sent && pos < argc; ++pos) {
+        sent = write_string(fd, argv[pos]);
+    }
+    sent = sent && write_string(fd, input);
+
+    std::string out;
+    std::string err;
+    std::uint64_t code = 1;
+    bool received = (
+        sent
+        && read_string(fd, out)
+        && read_string(fd, err)
+        && read_number(fd, code)
+    );
+    ::close(fd);
+
+    if (!received) {
+        /* The input is given again to the command run here. */
+        static std::istringstream input_stream;
+        input_stream.str(std::move(input));
+        std::cin.rdbuf(input_stream.rdbuf());
+        return std::nullopt;
+    }
+    std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+    std::cout.flush();
+    std::cerr.write(err.data(), static_cast<std::streamsize>(err.size()));
+    std::cerr.flush();
+    return static_cast<int>(code);
+}
+
+} // namespace dappi
+
+#endif
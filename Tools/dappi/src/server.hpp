@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <optional>
+
+namespace dappi {
+
+/*
+ * "serve --socket PATH [--idle-timeout SECONDS] [--cache-size MIB]" listens
+ * on a Unix domain socket for the commands of other dappi processes, and
+ * keeps the results of load, match and run in memory. Repeated commands,
+ * like the awareness files of the same revisions or the same resolution
+ * from concurrent configurations, are answered without running them again.
+ * Others are run by the executable of the server.
+ */
+int serve(int argc, char *argv[], const char *executable);
+
+/*
+ * Runs the command on the server listening on DAPPI_SOCKET, and returns its
+ * exit code. Returns nullopt if the command is to be run in this process,
+ * which is when no server is listening or the command writes files.
+ */
+std::optional<int> forward_to_server(int argc, char *argv[]);
+
+} // namespace dappi
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "sha512.hpp"
+
+namespace dappi {
+
+namespace {
+
+constexpr std::array<std::uint64_t, 80> round_constants = {
+    0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f,
+    0xe9b5dba58189dbbc, 0x3956c25bf348b538, 0x59f111f1b605d019,
+    0x923f82a4af194f9b, 0xab1c5ed5da6d8118, 0xd807aa98a3030242,
+    0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+    0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235,
+    0xc19bf174cf692694, 0xe49b69c19ef14ad2, 0xefbe4786384f25e3,
+    0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65, 0x2de92c6f592b0275,
+    0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+    0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f,
+    0xbf597fc7beef0ee4, 0xc6e00bf33da88fc2, 0xd5a79147930aa725,
+    0x06ca6351e003826f, 0x142929670a0e6e70, 0x27b70a8546d22ffc,
+    0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+    0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6,
+    0x92722c851482353b, 0xa2bfe8a14cf10364, 0xa81a664bbc423001,
+    0xc24b8b70d0f89791, 0xc76c51a30654be30, 0xd192e819d6ef5218,
+    0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
+    0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99,
+    0x34b0bcb5e19b48a8, 0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb,
+    0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3, 0x748f82ee5defb2fc,
+    0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+    0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915,
+    0xc67178f2e372532b, 0xca273eceea26619c, 0xd186b8c721c0c207,
+    0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178, 0x06f067aa72176fba,
+    0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
+    0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc,
+    0x431d67c49c100d4c, 0x4cc5d4becb3e42b6, 0x597f299cfc657e2a,
+    0x5fcb6fab3ad6faec, 0x6c44198c4a475817
+};
+
+constexpr std::uint64_t rotate_right(std::uint64_t x, int n) noexcept {
+    return (x >> n) | (x << (64 - n));
+}
+
+} // namespace
+
+sha512::sha512() noexcept : M_state{
+    0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b,
+    0xa54ff53a5f1d36f1, 0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+    0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+} {
+}
+
+void sha512::transform(const unsigned char *block) noexcept {
+    std::array<std::uint64_t, 80> w;
+    for (int t = 0; t < 16; ++t) {
+        std::uint64_t word = 0;
+        for (int byte = 0; byte < 8; ++byte) {
+            word = (word << 8) | block[t * 8 + byte];
+        }
+        w[t] = word;
+    }
+    for (int t = 16; t < 80; ++t) {
+        auto s0 = rotate_right(w[t - 15], 1)
+            ^ rotate_right(w[t - 15], 8)
+            ^ (w[t - 15] >> 7);
+        auto s1 = rotate_right(w[t - 2], 19)
+            ^ rotate_right(w[t - 2], 61)
+            ^ (w[t - 2] >> 6);
+        w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+
+    auto [a, b, c, d, e, f, g, h] = M_state;
+    for (int t = 0; t < 80; ++t) {
+        auto s1 = rotate_right(e, 14) ^ rotate_right(e, 18)
+            ^ rotate_right(e, 41);
+        auto choice = (e & f) ^ (~e & g);
+        auto temp1 = h + s1 + choice + round_constants[t] + w[t];
+        auto s0 = rotate_right(a, 28) ^ rotate_right(a, 34)
+            ^ rotate_right(a, 39);
+        auto majority = (a & b) ^ (a & c) ^ (b & c);
+        auto temp2 = s0 + majority;
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    M_state[0] += a;
+    M_state[1] += b;
+    M_state[2] += c;
+    M_state[3] += d;
+    M_state[4] += e;
+    M_state[5] += f;
+    M_state[6] += g;
+    M_state[7] += h;
+}
+
+void sha512::update(std::string_view data) noexcept {
+    M_length += data.size();
+    for (unsigned char c : data) {
+        M_block[M_block_size++] = c;
+        if (M_block_size == M_block.size()) {
+            transform(M_block.data());
+            M_block_size = 0;
+        }
+    }
+}
+
+std::string sha512::hex_digest() {
+    /* The length in bits fits in the lower half of the 128-bit field. */
+    std::uint64_t bit_length = M_length * 8;
+    M_block[M_block_size++] = 0x80;
+    if (M_block_size > M_block.size() - 16) {
+        while (M_block_size < M_block.size()) {
+            M_block[M_block_size++] = 0;
+        }
+        transform(M_block.data());
+        M_block_size = 0;
+    }
+    while (M_block_size < M_block.size() - 8) {
+        M_block[M_block_size++] = 0;
+    }
+    for (int byte = 7; byte >= 0; --byte) {
+        M_block[M_block_size++] =
+            static_cast<unsigned char>(bit_length >> (byte * 8));
+    }
+    transform(M_block.data());
+    M_block_size = 0;
+
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(128);
+    for (auto word : M_state) {
+        for (int shift = 60; shift >= 0; shift -= 4) {
+            result += digits[(word >> shift) & 0xf];
+        }
+    }
+    return result;
+}
+
+} // namespace dappi
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef SHA512_HPP
+#define SHA512_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace dappi {
+
+/*
+ * Computes SHA-512 digests, which dapper uses for integrities of packages.
+ */
+class sha512 {
+private:
+    std::array<std::uint64_t, 8> M_state;
+    std::array<unsigned char, 128> M_block;
+    std::size_t M_block_size = 0;
+    std::uint64_t M_length = 0;
+
+    void transform(const unsigned char *block) noexcept;
+
+public:
+    sha512() noexcept;
+
+    void update(std::string_view data) noexcept;
+
+    /* Returns the digest in lowercase hex, like `cmake -E sha512sum`. */
+    std::string hex_digest();
+};
+
+inline std::string sha512_hex(std::string_view data) {
+    sha512 hash;
+    hash.update(data);
+    return hash.hex_digest();
+}
+
+} // namespace dappi
+
+#endif
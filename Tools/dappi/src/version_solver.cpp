@@ -0,0 +1,898 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#include "version_solver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace dappi {
+
+namespace {
+
+constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+/*
+ * A set of candidates of a name, as disjoint [begin, end) ranges of their
+ * ranks in ascending order. Ranks are positions in the order of versions.
+ */
+class version_ranges {
+private:
+    std::vector<std::pair<std::size_t, std::size_t>> M_ranges;
+
+    void append(std::size_t begin, std::size_t end) {
+        if (begin >= end) {
+            return;
+        } else if (!M_ranges.empty() && M_ranges.back().second >= begin) {
+            M_ranges.back().second = std::max(M_ranges.back().second, end);
+        } else {
+            M_ranges.emplace_back(begin, end);
+        }
+    }
+
+public:
+    version_ranges() = default;
+
+    version_ranges(std::size_t begin, std::size_t end) {
+        append(begin, end);
+    }
+
+    /* Makes the ranges covering the given ranks, which are sorted. */
+    static version_ranges from_ranks(const std::vector<std::size_t> &ranks) {
+        version_ranges result;
+        for (auto rank : ranks) {
+            result.append(rank, rank + 1);
+        }
+        return result;
+    }
+
+    const std::vector<std::pair<std::size_t, std::size_t>> &
+    ranges() const noexcept {
+        return M_ranges;
+    }
+
+    bool empty() const noexcept {
+        return M_ranges.empty();
+    }
+
+    bool contains(std::size_t rank) const {
+        auto found = std::upper_bound(
+            M_ranges.begin(),
+            M_ranges.end(),
+            rank,
+            [](std::size_t lhs, auto &rhs) { return lhs < rhs.second; }
+        );
+        return found != M_ranges.end() && found->first <= rank;
+    }
+
+    version_ranges intersect(const version_ranges &other) const {
+        version_ranges result;
+        std::size_t lhs = 0;
+        std::size_t rhs = 0;
+        while (lhs < M_ranges.size() && rhs < other.M_ranges.size()) {
+            auto &a = M_ranges[lhs];
+            auto &b = other.M_ranges[rhs];
+            result.append(std::max(a.first, b.first),
+                          std::min(a.second, b.second));
+            if (a.second < b.second) {
+                ++lhs;
+            } else {
+                ++rhs;
+            }
+        }
+        return result;
+    }
+
+    version_ranges unite(const version_ranges &other) const {
+        std::vector<std::pair<std::size_t, std::size_t>> all;
+        all.reserve(M_ranges.size() + other.M_ranges.size());
+        std::merge(
+            M_ranges.begin(),
+            M_ranges.end(),
+            other.M_ranges.begin(),
+            other.M_ranges.end(),
+            std::back_inserter(all)
+        );
+        version_ranges result;
+        for (auto &[begin, end] : all) {
+            result.append(begin, end);
+        }
+        return result;
+    }
+
+    version_ranges subtract(const version_ranges &other) const {
+        version_ranges result;
+        std::size_t first = 0;
+        for (auto [begin, end] : M_ranges) {
+            auto &cuts = other.M_ranges;
+            while (first < cuts.size() && cuts[first].second <= begin) {
+                ++first;
+            }
+            auto current = begin;
+            for (auto pos = first; current < end; ++pos) {
+                if (pos == cuts.size() || cuts[pos].first >= end) {
+                    result.append(current, end);
+                    break;
+                }
+                result.append(current, cuts[pos].first);
+                current = std::max(current, cuts[pos].second);
+            }
+        }
+        return result;
+    }
+
+    bool operator ==(const version_ranges &other) const {
+        return M_ranges == other.M_ranges;
+    }
+};
+
+/*
+ * "name is selected within ranges" if positive. Otherwise "name is not
+ * selected within ranges", which also holds if the name is not selected at
+ * all, so a negative term of no ranges holds for anything.
+ */
+struct term {
+    std::size_t name;
+    bool positive;
+    version_ranges ranges;
+};
+
+term negate(const term &operand) {
+    return { operand.name, !operand.positive, operand.ranges };
+}
+
+/* Both terms must be of the same name. */
+term intersect(const term &lhs, const term &rhs) {
+    if (lhs.positive && rhs.positive) {
+        return { lhs.name, true, lhs.ranges.intersect(rhs.ranges) };
+    } else if (lhs.positive) {
+        return { lhs.name, true, lhs.ranges.subtract(rhs.ranges) };
+    } else if (rhs.positive) {
+        return { lhs.name, true, rhs.ranges.subtract(lhs.ranges) };
+    } else {
+        return { lhs.name, false, lhs.ranges.unite(rhs.ranges) };
+    }
+}
+
+bool is_empty(const term &operand) {
+    return operand.positive && operand.ranges.empty();
+}
+
+bool is_any(const term &operand) {
+    return !operand.positive && operand.ranges.empty();
+}
+
+enum class relation {
+    satisfied,
+    contradicted,
+    inconclusive
+};
+
+/* Tells whether what is known of a name implies the term or its negation. */
+relation relate(const term &known, const term &operand) {
+    if (is_empty(intersect(known, operand))) {
+        return relation::contradicted;
+    } else if (is_empty(intersect(known, negate(operand)))) {
+        return relation::satisfied;
+    } else {
+        return relation::inconclusive;
+    }
+}
+
+/* Terms which cannot all hold, at most one per name */
+struct incompatibility {
+    std::vector<term> terms;
+
+    void add(const term &operand) {
+        for (auto &this_term : terms) {
+            if (this_term.name == operand.name) {
+                this_term = intersect(this_term, operand);
+                if (is_any(this_term)) {
+                    this_term = std::move(terms.back());
+                    terms.pop_back();
+                }
+                return;
+            }
+        }
+        if (!is_any(operand)) {
+            terms.push_back(operand);
+        }
+    }
+};
+
+/* The candidates of a name in the order of versions */
+struct name_order {
+    /* DAP of each rank */
+    std::vector<std::size_t> daps;
+
+    /* Rank of each position in the candidates of the name */
+    std::vector<std::size_t> ranks;
+
+    /* Number of ranks below each rank which are not dominated */
+    std::vector<std::size_t> selectable_below;
+
+    /* The highest rank below each rank which is not dominated, or npos */
+    std::vector<std::size_t> highest_below;
+
+    std::size_t count_selectable(const version_ranges &ranges) const {
+        std::size_t result = 0;
+        for (auto &[begin, end] : ranges.ranges()) {
+            result += selectable_below[end] - selectable_below[begin];
+        }
+        return result;
+    }
+
+    std::size_t highest_selectable(const version_ranges &ranges) const {
+        auto &all = ranges.ranges();
+        for (auto range = all.rbegin(); range != all.rend(); ++range) {
+            auto rank = highest_below[range->second];
+            if (rank != npos && rank >= range->first) {
+                return rank;
+            }
+        }
+        return npos;
+    }
+};
+
+/* What is shared by the searches of the roots */
+struct search_space {
+    const resolution_problem &problem;
+    std::vector<name_order> orders;
+
+    /* Ranges satisfying each dependency, by index of DAPs */
+    std::vector<std::vector<version_ranges>> requirements;
+
+    explicit search_space(const resolution_problem &problem);
+
+    /* Whether the DAP of the rank requires exactly the ranges of a name. */
+    bool has_requirement(
+        std::size_t name,
+        std::size_t rank,
+        std::size_t required_name,
+        const version_ranges &required
+    ) const {
+        auto dap = orders[name].daps[rank];
+        auto &dependencies = problem.daps[dap].dependencies;
+        for (std::size_t index = 0; index < dependencies.size(); ++index) {
+            if (
+                dependencies[index].name == required_name
+                && requirements[dap][index] == required
+            ) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+search_space::search_space(const resolution_problem &problem) :
+        problem(problem) {
+    orders.resize(problem.names.size());
+    for (std::size_t index = 0; index < problem.names.size(); ++index) {
+        auto &candidates = problem.names[index].candidates;
+        auto &order = orders[index];
+        std::vector<std::size_t> positions(candidates.size());
+        for (std::size_t pos = 0; pos < positions.size(); ++pos) {
+            positions[pos] = pos;
+        }
+        std::stable_sort(
+            positions.begin(),
+            positions.end(),
+            [&](std::size_t lhs, std::size_t rhs) {
+                return problem.daps[candidates[lhs]].version
+                    < problem.daps[candidates[rhs]].version;
+            }
+        );
+
+        order.ranks.resize(candidates.size());
+        order.selectable_below.push_back(0);
+        order.highest_below.push_back(npos);
+        for (std::size_t rank = 0; rank < positions.size(); ++rank) {
+            auto dap = candidates[positions[rank]];
+            order.daps.push_back(dap);
+            order.ranks[positions[rank]] = rank;
+            bool selectable = !problem.daps[dap].dominated;
+            order.selectable_below.push_back(
+                order.selectable_below.back() + (selectable ? 1 : 0)
+            );
+            order.highest_below.push_back(
+                selectable ? rank : order.highest_below.back()
+            );
+        }
+    }
+
+    /*
+     * Dominated candidates are never decided, so they are left in the
+     * ranges where they join the ranges around them.
+     */
+    requirements.resize(problem.daps.size());
+    for (std::size_t index = 0; index < problem.daps.size(); ++index) {
+        for (auto &dep : problem.daps[index].dependencies) {
+            std::vector<std::size_t> ranks;
+            for (auto pos : dep.satisfying) {
+                ranks.push_back(orders[dep.name].ranks[pos]);
+            }
+            std::sort(ranks.begin(), ranks.end());
+            requirements[index].push_back(version_ranges::from_ranks(ranks));
+        }
+    }
+}
+
+/*
+ * The search of one root, made of the partial solution of assignments and
+ * the incompatibilities derived so far.
+ */
+class search {
+private:
+    struct assignment {
+        term value;
+        std::size_t level;
+
+        /* The incompatibility it is derived from, or npos for decisions */
+        std::size_t cause;
+
+        /* The previous assignment of the name, or npos */
+        std::size_t previous;
+
+        /* Intersection of the assignments of the name up to this one */
+        term known;
+    };
+
+    struct requirement_entry {
+        version_ranges depender;
+        std::size_t name;
+        version_ranges required;
+        std::size_t index;
+    };
+
+    const search_space &M_space;
+    const problem_root &M_root;
+    version_solving_statistics &M_statistics;
+    std::vector<incompatibility> M_incompatibilities;
+    std::vector<std::vector<std::size_t>> M_incompatibilities_of;
+    std::vector<std::vector<requirement_entry>> M_requirements_of;
+    std::vector<assignment> M_assignments;
+    std::vector<std::size_t> M_last;
+    std::vector<std::optional<std::size_t>> M_decisions;
+    std::vector<std::size_t> M_pending;
+    std::vector<bool> M_is_pending;
+    std::size_t M_level = 0;
+
+    const term &known(std::size_t name) const {
+        static const term anything = { 0, false, {} };
+        auto last = M_last[name];
+        return last == npos ? anything : M_assignments[last].known;
+    }
+
+    std::size_t add(incompatibility new_incompatibility);
+    std::vector<std::size_t> add_requirements(
+        std::size_t name,
+        std::size_t rank
+    );
+    void assign(term value, std::size_t cause);
+    relation classify(
+        const incompatibility &target,
+        std::size_t &unsatisfied
+    );
+    std::size_t find_satisfier(
+        const incompatibility &target,
+        std::size_t end,
+        const term *initial
+    ) const;
+    std::optional<std::size_t> resolve_conflict(std::size_t index);
+    void backtrack(std::size_t level);
+    bool propagate(std::size_t name);
+    std::optional<std::size_t> next_name();
+
+public:
+    search(
+        const search_space &space,
+        const problem_root &root,
+        version_solving_statistics &statistics
+    );
+
+    /* Returns the selected DAP of each name, or nullopt if conflicted. */
+    std::optional<std::vector<std::optional<std::size_t>>> solve();
+};
+
+search::search(
+    const search_space &space,
+    const problem_root &root,
+    version_solving_statistics &statistics
+) : M_space(space),
+    M_root(root),
+    M_statistics(statistics) {
+    auto num_names = space.problem.names.size();
+    M_incompatibilities_of.resize(num_names);
+    M_requirements_of.resize(num_names);
+    M_last.resize(num_names, npos);
+    M_decisions.resize(num_names);
+    M_is_pending.resize(num_names, false);
+}
+
+std::size_t search::add(incompatibility new_incompatibility) {
+    auto index = M_incompatibilities.size();
+    for (auto &this_term : new_incompatibility.terms) {
+        M_incompatibilities_of[this_term.name].push_back(index);
+    }
+    M_incompatibilities.push_back(std::move(new_incompatibility));
+    return index;
+}
+
+/*
+ * Adds the requirements of the candidate of the rank unless known, and
+ * returns them. Each one covers the adjacent ranks requiring the same, so
+ * that the others are ruled out along with it.
+ */
+std::vector<std::size_t> search::add_requirements(
+    std::size_t name,
+    std::size_t rank
+) {
+    std::vector<std::size_t> result;
+    auto &order = M_space.orders[name];
+    auto dap = order.daps[rank];
+    auto &dependencies = M_space.problem.daps[dap].dependencies;
+    for (std::size_t index = 0; index < dependencies.size(); ++index) {
+        auto required_name = dependencies[index].name;
+        auto &required = M_space.requirements[dap][index];
+
+        auto &known_requirements = M_requirements_of[name];
+        auto found = std::find_if(
+            known_requirements.begin(),
+            known_requirements.end(),
+            [&](const requirement_entry &entry) {
+                return entry.name == required_name
+                    && entry.required == required
+                    && entry.depender.contains(rank);
+            }
+        );
+        if (found != known_requirements.end()) {
+            result.push_back(found->index);
+            continue;
+        }
+
+        auto begin = rank;
+        auto end = rank + 1;
+        while (
+            begin > 0
+            && M_space.has_requirement(
+                name, begin - 1, required_name, required
+            )
+        ) {
+            --begin;
+        }
+        while (
+            end < order.daps.size()
+            && M_space.has_requirement(name, end, required_name, required)
+        ) {
+            ++end;
+        }
+
+        version_ranges depender(begin, end);
+        incompatibility new_incompatibility;
+        new_incompatibility.add({ name, true, depender });
+        new_incompatibility.add({ required_name, false, required });
+        auto new_index = add(std::move(new_incompatibility));
+        known_requirements.push_back(
+            { std::move(depender), required_name, required, new_index }
+        );
+        result.push_back(new_index);
+        ++M_statistics.requirements;
+    }
+    return result;
+}
+
+void search::assign(term value, std::size_t cause) {
+    auto name = value.name;
+    auto new_known = intersect(value, known(name));
+    M_assignments.push_back(
+        { std::move(value), M_level, cause, M_last[name], new_known }
+    );
+    M_last[name] = M_assignments.size() - 1;
+    if (cause != npos) {
+        ++M_statistics.derivations;
+    }
+    if (new_known.positive && !M_decisions[name] && !M_is_pending[name]) {
+        M_is_pending[name] = true;
+        M_pending.push_back(name);
+    }
+}
+
+/*
+ * Returns satisfied, contradicted, or inconclusive with the index of the
+ * only term which is not satisfied, if there is one, in unsatisfied.
+ */
+relation search::classify(
+    const incompatibility &target,
+    std::size_t &unsatisfied
+) {
+    unsatisfied = npos;
+    for (std::size_t index = 0; index < target.terms.size(); ++index) {
+        auto &this_term = target.terms[index];
+        switch (relate(known(this_term.name), this_term)) {
+        case relation::satisfied:
+            break;
+        case relation::contradicted:
+            unsatisfied = npos;
+            return relation::contradicted;
+        case relation::inconclusive:
+            if (unsatisfied != npos) {
+                unsatisfied = npos;
+                return relation::inconclusive;
+            }
+            unsatisfied = index;
+            break;
+        }
+    }
+    return unsatisfied == npos
+        ? relation::satisfied
+        : relation::inconclusive;
+}
+
+/*
+ * Returns the position of the earliest assignment before the end with
+ * which the assignments up to it satisfy every term, starting from the
+ * initial term for its name. npos if the initial term satisfies it alone.
+ */
+std::size_t search::find_satisfier(
+    const incompatibility &target,
+    std::size_t end,
+    const term *initial
+) const {
+    std::vector<term> accumulated;
+    std::size_t unsatisfied = 0;
+    for (auto &this_term : target.terms) {
+        term start = { this_term.name, false, {} };
+        if (initial && initial->name == this_term.name) {
+            start = *initial;
+        }
+        if (relate(start, this_term) != relation::satisfied) {
+            ++unsatisfied;
+        }
+        accumulated.push_back(std::move(start));
+    }
+    if (unsatisfied == 0) {
+        return npos;
+    }
+
+    for (std::size_t pos = 0; pos < end; ++pos) {
+        auto &value = M_assignments[pos].value;
+        for (std::size_t index = 0; index < target.terms.size(); ++index) {
+            auto &this_term = target.terms[index];
+            if (this_term.name != value.name) {
+                continue;
+            }
+            auto &current = accumulated[index];
+            bool was_satisfied = (
+                relate(current, this_term) == relation::satisfied
+            );
+            current = intersect(current, value);
+            if (
+                !was_satisfied
+                && relate(current, this_term) == relation::satisfied
+                && --unsatisfied == 0
+            ) {
+                return pos;
+            }
+            break;
+        }
+    }
+    return end;
+}
+
+/*
+ * Derives the root cause of the satisfied incompatibility by resolution
+ * with the causes of its satisfiers, and backjumps to where it is almost
+ * satisfied. Returns nullopt if the cause is the root itself.
+ */
+std::optional<std::size_t> search::resolve_conflict(std::size_t index) {
+    ++M_statistics.conflicts;
+    auto current = M_incompatibilities[index];
+    bool learned = false;
+    for (;;) {
+        if (current.terms.empty()) {
+            return std::nullopt;
+        }
+
+        auto satisfier_pos = find_satisfier(
+            current,
+            M_assignments.size(),
+            nullptr
+        );
+        auto &satisfier = M_assignments[satisfier_pos];
+        auto found = std::find_if(
+            current.terms.begin(),
+            current.terms.end(),
+            [&](const term &this_term) {
+                return this_term.name == satisfier.value.name;
+            }
+        );
+        auto satisfied_term = *found;
+
+        auto previous_pos = find_satisfier(
+            current,
+            satisfier_pos,
+            &satisfier.value
+        );
+        std::size_t previous_level = 0;
+        if (previous_pos != npos) {
+            previous_level = M_assignments[previous_pos].level;
+        }
+
+        if (satisfier.cause == npos || previous_level != satisfier.level) {
+            if (learned) {
+                index = add(std::move(current));
+                ++M_statistics.learned;
+            }
+            backtrack(previous_level);
+            return index;
+        }
+
+        /* Resolves the satisfier out with its cause. */
+        incompatibility prior_cause;
+        auto name = satisfier.value.name;
+        for (auto &this_term : current.terms) {
+            if (this_term.name != name) {
+                prior_cause.add(this_term);
+            }
+        }
+        for (auto &this_term : M_incompatibilities[satisfier.cause].terms) {
+            if (this_term.name != name) {
+                prior_cause.add(this_term);
+            }
+        }
+        if (
+            relate(satisfier.value, satisfied_term)
+            != relation::satisfied
+        ) {
+            prior_cause.add(
+                negate(intersect(satisfier.value, negate(satisfied_term)))
+            );
+        }
+        current = std::move(prior_cause);
+        learned = true;
+    }
+}
+
+void search::backtrack(std::size_t level) {
+    while (!M_assignments.empty() && M_assignments.back().level > level) {
+        auto &last = M_assignments.back();
+        auto name = last.value.name;
+        M_last[name] = last.previous;
+        if (last.cause == npos) {
+            M_decisions[name].reset();
+        }
+        M_assignments.pop_back();
+
+        auto &now_known = known(name);
+        if (now_known.positive && !M_decisions[name] && !M_is_pending[name]) {
+            M_is_pending[name] = true;
+            M_pending.push_back(name);
+        }
+    }
+    M_level = level;
+}
+
+/*
+ * Derives what the incompatibilities of the name imply until nothing is
+ * left, resolving conflicts on the way. Returns false if the root
+ * conflicts.
+ */
+bool search::propagate(std::size_t name) {
+    std::vector<std::size_t> changed = { name };
+    while (!changed.empty()) {
+        auto package = changed.back();
+        changed.pop_back();
+
+        /* Newer incompatibilities tend to find conflicts earlier. */
+        for (auto pos = M_incompatibilities_of[package].size(); pos-- > 0;) {
+            auto index = M_incompatibilities_of[package][pos];
+            std::size_t unsatisfied;
+            auto result = classify(M_incompatibilities[index], unsatisfied);
+            if (result == relation::satisfied) {
+                auto root_cause = resolve_conflict(index);
+                if (!root_cause) {
+                    return false;
+                }
+                classify(M_incompatibilities[*root_cause], unsatisfied);
+                auto &derived = M_incompatibilities[*root_cause].terms;
+                auto derived_term = derived[unsatisfied];
+                assign(negate(derived_term), *root_cause);
+                changed.assign(1, derived_term.name);
+                break;
+            } else if (unsatisfied != npos) {
+                auto derived_term =
+                    M_incompatibilities[index].terms[unsatisfied];
+                assign(negate(derived_term), index);
+                changed.push_back(derived_term.name);
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * Returns the undecided name which has to be selected, earlier strata
+ * first, then the one with the fewest candidates left.
+ */
+std::optional<std::size_t> search::next_name() {
+    std::optional<std::size_t> result;
+    std::tuple<std::size_t, std::size_t, std::size_t> best;
+    std::size_t kept = 0;
+    for (auto name : M_pending) {
+        auto &this_known = known(name);
+        if (M_decisions[name] || !this_known.positive) {
+            M_is_pending[name] = false;
+            continue;
+        }
+        M_pending[kept++] = name;
+        std::tuple<std::size_t, std::size_t, std::size_t> key = {
+            M_space.problem.names[name].stratum,
+            M_space.orders[name].count_selectable(this_known.ranges),
+            name
+        };
+        if (!result || key < best) {
+            result = name;
+            best = key;
+        }
+    }
+    M_pending.resize(kept);
+    return result;
+}
+
+std::optional<std::vector<std::optional<std::size_t>>> search::solve() {
+    if (M_root.entry) {
+        auto entry = *M_root.entry;
+        auto &dependencies = M_space.problem.daps[entry].dependencies;
+        for (std::size_t index = 0; index < dependencies.size(); ++index) {
+            incompatibility requirement;
+            requirement.add({
+                dependencies[index].name,
+                false,
+                M_space.requirements[entry][index]
+            });
+            if (requirement.terms.empty()) {
+                return std::nullopt;
+            }
+            auto name = requirement.terms.front().name;
+            add(std::move(requirement));
+            ++M_statistics.requirements;
+            if (!propagate(name)) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    for (;;) {
+        auto name = next_name();
+        if (!name) {
+            break;
+        }
+
+        auto &order = M_space.orders[*name];
+        auto &allowed = known(*name).ranges;
+        auto rank = npos;
+        auto &locked = M_root.locked[*name];
+        if (locked && !M_space.problem.names[*name].updating) {
+            auto found = std::find(
+                order.daps.begin(),
+                order.daps.end(),
+                *locked
+            );
+            std::size_t locked_rank = found - order.daps.begin();
+            if (
+                found != order.daps.end()
+                && allowed.contains(locked_rank)
+                && !M_space.problem.daps[*locked].dominated
+            ) {
+                rank = locked_rank;
+            }
+        }
+        if (rank == npos) {
+            rank = order.highest_selectable(allowed);
+        }
+
+        if (rank == npos) {
+            /* No candidate is left for what has been derived. */
+            incompatibility no_versions;
+            no_versions.add({ *name, true, allowed });
+            add(std::move(no_versions));
+            if (!propagate(*name)) {
+                return std::nullopt;
+            }
+            continue;
+        }
+
+        /* The candidate is not decided if it would break a requirement. */
+        bool breaking = false;
+        for (auto index : add_requirements(*name, rank)) {
+            auto &requirement = M_incompatibilities[index];
+            breaking = std::all_of(
+                requirement.terms.begin(),
+                requirement.terms.end(),
+                [&](const term &this_term) {
+                    if (this_term.name == *name) {
+                        return this_term.ranges.contains(rank)
+                            == this_term.positive;
+                    }
+                    return relate(known(this_term.name), this_term)
+                        == relation::satisfied;
+                }
+            );
+            if (breaking) {
+                break;
+            }
+        }
+        if (!breaking) {
+            ++M_level;
+            ++M_statistics.decisions;
+            M_decisions[*name] = rank;
+            assign({ *name, true, version_ranges(rank, rank + 1) }, npos);
+        }
+        if (!propagate(*name)) {
+            return std::nullopt;
+        }
+    }
+
+    std::vector<std::optional<std::size_t>> result(M_decisions.size());
+    for (std::size_t name = 0; name < M_decisions.size(); ++name) {
+        if (M_decisions[name]) {
+            result[name] = M_space.orders[name].daps[*M_decisions[name]];
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+version_solver::version_solver(const resolution_problem &problem) :
+        selection_set(problem) {
+}
+
+resolution_status version_solver::resolve() {
+    auto start = std::chrono::steady_clock::now();
+    search_space space(M_problem);
+
+    auto status = resolution_status::feasible;
+    for (M_root = 0; M_root < M_problem.roots.size(); ++M_root) {
+        search this_search(space, M_problem.roots[M_root], M_statistics);
+        auto selections = this_search.solve();
+        if (selections) {
+            M_selections[M_root] = std::move(*selections);
+            continue;
+        }
+        status = resolution_status::conflicted;
+        break;
+    }
+    M_statistics.seconds += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+    return status;
+}
+
+} // namespace dappi
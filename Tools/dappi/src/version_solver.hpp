@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024 Flokart World, Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *    1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ *
+ *    2. Altered source versions must be plainly marked as such, and must not
+ *    be misrepresented as being the original software.
+ *
+ *    3. This notice may not be removed or altered from any source
+ *    distribution.
+ */
+
+#ifndef VERSION_SOLVER_HPP
+#define VERSION_SOLVER_HPP
+
+#include <optional>
+#include "resolution_problem.hpp"
+#include "resolution_statistics.hpp"
+#include "resolver.hpp"
+#include "selection_set.hpp"
+
+namespace dappi {
+
+/*
+ * Searches the selections directly on the versions of the names in the way
+ * of PubGrub, instead of encoding the problem into SAT. Requirements are
+ * kept as incompatibilities over ranges of versions, and conflicts are
+ * learned as such ranges as well.
+ *
+ * Each name is decided on the locked version if it is allowed and the name
+ * is not updating, otherwise on the newest one allowed. The selections are
+ * valid, but unlocks and penalties are not minimized across names as the
+ * resolver does, so they are not always the same as its selections.
+ */
+class version_solver : public selection_set {
+private:
+    version_solving_statistics M_statistics;
+
+public:
+    explicit version_solver(const resolution_problem &problem);
+
+    version_solver(const version_solver &) = delete;
+    version_solver &operator =(const version_solver &) = delete;
+
+    /*
+     * Resolves the roots one by one, and returns feasible once each has its
+     * selections, since they are not minimized. Stops at the first root
+     * which is conflicted. There are no limits to apply, as the search for
+     * the first selections is all it does.
+     */
+    resolution_status resolve();
+
+    const version_solving_statistics &statistics() const noexcept {
+        return M_statistics;
+    }
+};
+
+} // namespace dappi
+
+#endif
@@ -23,14 +23,22 @@
 
 #include "violation_counter_merger.hpp"
 
+namespace dappi {
+
 violation_counter_set violation_counter_merger::pop() noexcept {
-    std::pop_heap(M_queue.begin(), M_queue.end(), size_greater());
-    auto result = std::move(M_queue.back());
-    M_queue.pop_back();
-    return result;
+    if (M_order == merge_order::smallest_first) {
+        std::pop_heap(M_queue.begin(), M_queue.end(), size_greater());
+        auto result = std::move(M_queue.back());
+        M_queue.pop_back();
+        return result;
+    } else {
+        auto result = std::move(M_queue.front());
+        M_queue.pop_front();
+        return result;
+    }
 }
 
-void violation_counter_merger::merge(Minisat::Solver &solver) {
+void violation_counter_merger::merge(Minisat::SimpSolver &solver) {
     assert(!empty());
 
     while (M_queue.size() > 1) {
@@ -81,6 +89,13 @@ void violation_counter_merger::merge(Minisat::Solver &solver) {
             }
         }
 
-        add(violation_counter_set(std::move(counters)));
+        if (M_order == merge_order::smallest_first) {
+            add(violation_counter_set(std::move(counters)));
+        } else {
+            /* The merged set is the head of the chain. */
+            M_queue.push_front(violation_counter_set(std::move(counters)));
+        }
     }
 }
+
+} // namespace dappi
@@ -26,9 +26,23 @@
 
 #include <cassert>
 #include <queue>
-#include <minisat/core/Solver.h>
+#include <minisat/simp/SimpSolver.h>
 #include "violation_counter_set.hpp"
 
+namespace dappi {
+
+/*
+ * Determines the shape of the counter tree built by the merger.
+ *
+ * smallest_first always merges the two smallest counter sets, which keeps
+ * the tree balanced like a totalizer. sequential folds the sets into one
+ * chain in the order they were added.
+ */
+enum class merge_order {
+    smallest_first,
+    sequential
+};
+
 class violation_counter_merger {
 private:
     struct size_greater {
@@ -40,11 +54,17 @@ private:
         }
     };
 
+    merge_order M_order;
     std::deque<violation_counter_set> M_queue;
 
     violation_counter_set pop() noexcept;
 
 public:
+    explicit violation_counter_merger(
+        merge_order order = merge_order::smallest_first
+    ) noexcept : M_order(order) {
+    }
+
     bool empty() const noexcept {
         return M_queue.empty();
     }
@@ -58,10 +78,14 @@ public:
 
     void add(violation_counter_set group) {
         M_queue.push_back(std::move(group));
-        std::push_heap(M_queue.begin(), M_queue.end(), size_greater());
+        if (M_order == merge_order::smallest_first) {
+            std::push_heap(M_queue.begin(), M_queue.end(), size_greater());
+        }
     }
 
-    void merge(Minisat::Solver &solver);
+    void merge(Minisat::SimpSolver &solver);
 };
 
+} // namespace dappi
+
 #endif
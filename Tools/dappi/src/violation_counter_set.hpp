@@ -28,6 +28,8 @@
 #include <vector>
 #include <minisat/core/SolverTypes.h>
 
+namespace dappi {
+
 /*
  * Represents a set of violation counters for solving MaxSAT problem.
  */
@@ -59,4 +61,6 @@ public:
     }
 };
 
+} // namespace dappi
+
 #endif
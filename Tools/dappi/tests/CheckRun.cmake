@@ -0,0 +1,59 @@
+# Copyright (c) 2024 Flokart World, Inc.
+#
+# This software is provided 'as-is', without any express or implied
+# warranty. In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+#    1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation would be
+#    appreciated but is not required.
+#
+#    2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+#
+#    3. This notice may not be removed or altered from any source distribution.
+
+
+# Runs "dappi run" on an input and checks its output, failing unless each
+# line of the expectation matches a line of the output as a regex.
+#
+#   cmake -D DAPPI=<dappi> -D INPUT=<json> -D EXPECTED=<file>
+#         [-D "ARGS=<arguments of dappi run>"]
+#         -P CheckRun.cmake
+
+cmake_minimum_required (VERSION 3.14)
+
+separate_arguments (-args UNIX_COMMAND "${ARGS}")
+execute_process (
+  COMMAND "${DAPPI}" run ${-args}
+  INPUT_FILE "${INPUT}"
+  OUTPUT_VARIABLE -output
+  RESULT_VARIABLE -code
+)
+if (NOT -code EQUAL 0)
+  message (FATAL_ERROR "dappi run ${ARGS} failed.")
+endif ()
+
+string (REGEX REPLACE "\n$" "" -output "${-output}")
+string (REPLACE "\n" ";" -lines "${-output}")
+file (STRINGS "${EXPECTED}" -patterns)
+foreach (-pattern IN LISTS -patterns)
+  set (-matched false)
+  foreach (-line IN LISTS -lines)
+    if (-line MATCHES "${-pattern}")
+      set (-matched true)
+      break ()
+    endif ()
+  endforeach ()
+  if (NOT -matched)
+    message (
+      FATAL_ERROR
+      "No line of the output matches ${-pattern}:\n${-output}"
+    )
+  endif ()
+endforeach ()